@@ -0,0 +1,89 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "asset_cache.h"
+#include "frame_timer.h"
+#include "render_backend.h"
+#include "sdl_wrapper.h"
+
+/**
+ * Measures asset_cache_obj_get_or_create() lookups as the cache grows to
+ * hundreds of assets, against the linear strcmp() scan it used to do.
+ * Images are "loaded" through the null render backend, so no files or window
+ * are needed. Lookups go round-robin over every cached path, half with the
+ * caller's original string and half with an equal copy of it, as callers
+ * passing string literals and callers building paths at runtime would.
+ *
+ * Usage: bin/asset_cache_bench [lookups]
+ */
+
+const size_t DEFAULT_LOOKUPS = 2000000;
+const size_t CACHE_SIZES[] = {8, 64, 256, 512, 1024};
+const size_t PATH_LENGTH = 64;
+
+/**
+ * The old cache's lookup: compares the path against every cached path.
+ */
+static size_t linear_find(char **paths, size_t num_paths, const char *path) {
+  for (size_t i = 0; i < num_paths; i++) {
+    if (strcmp(paths[i], path) == 0) {
+      return i;
+    }
+  }
+  return num_paths;
+}
+
+static void bench(size_t num_paths, size_t lookups) {
+  // two equal strings per path: the one it was loaded with, and a copy
+  char **paths = malloc(sizeof(char *) * num_paths * 2);
+  assert(paths);
+  for (size_t i = 0; i < num_paths * 2; i++) {
+    paths[i] = malloc(PATH_LENGTH);
+    assert(paths[i]);
+    snprintf(paths[i], PATH_LENGTH, "assets/bench/sprite_%zu.png",
+             i % num_paths);
+  }
+
+  asset_cache_init();
+  for (size_t i = 0; i < num_paths; i++) {
+    asset_cache_obj_get_or_create(ASSET_IMAGE, paths[i]);
+  }
+  assert(asset_cache_size() == num_paths);
+
+  uint64_t start = timer_now_ns();
+  for (size_t i = 0; i < lookups; i++) {
+    asset_cache_obj_get_or_create(ASSET_IMAGE, paths[i % (num_paths * 2)]);
+  }
+  double hashed = (double)(timer_now_ns() - start) / lookups;
+  assert(asset_cache_size() == num_paths);
+
+  start = timer_now_ns();
+  size_t found = 0;
+  for (size_t i = 0; i < lookups; i++) {
+    found += linear_find(paths, num_paths, paths[i % (num_paths * 2)]);
+  }
+  double linear = (double)(timer_now_ns() - start) / lookups;
+
+  printf("%5zu assets %8.1f ns/lookup  linear %8.1f ns/lookup  %6.1fx\n",
+         num_paths, hashed, linear, linear / hashed);
+  // keeps the linear scans from being optimized away
+  if (found == (size_t)-1) {
+    printf("unreachable\n");
+  }
+
+  asset_cache_destroy();
+  for (size_t i = 0; i < num_paths * 2; i++) {
+    free(paths[i]);
+  }
+  free(paths);
+}
+
+int main(int argc, char *argv[]) {
+  size_t lookups = argc > 1 ? strtoul(argv[1], NULL, 10) : DEFAULT_LOOKUPS;
+  sdl_set_render_backend(&RENDER_BACKEND_NULL);
+  for (size_t i = 0; i < sizeof(CACHE_SIZES) / sizeof(CACHE_SIZES[0]); i++) {
+    bench(CACHE_SIZES[i], lookups);
+  }
+}
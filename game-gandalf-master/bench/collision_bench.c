@@ -0,0 +1,87 @@
+#include <assert.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "body.h"
+#include "collision.h"
+#include "frame_timer.h"
+
+/**
+ * Measures find_collision() throughput on the shapes the game uses:
+ * 20-vertex ships against each other and against 4-vertex asteroids,
+ * both touching and far apart.
+ *
+ * Usage: bin/collision_bench [iterations]
+ */
+
+const size_t DEFAULT_ITERATIONS = 200000;
+const size_t BENCH_SHIP_POINTS = 20;
+const double BENCH_SHIP_RADIUS = 15;
+const vector_t BENCH_ASTEROID_SIZE = {50, 30};
+
+static body_t *make_ship(vector_t center) {
+  list_t *points = list_init(BENCH_SHIP_POINTS, free);
+  for (size_t i = 0; i < BENCH_SHIP_POINTS; i++) {
+    double angle = 2 * M_PI * i / BENCH_SHIP_POINTS;
+    vector_t *v = malloc(sizeof(vector_t));
+    assert(v);
+    *v = vec_add(center, create_vector(BENCH_SHIP_RADIUS, angle));
+    list_add(points, v);
+  }
+  return body_init(points, 1, (rgb_color_t){0, 0, 0});
+}
+
+static body_t *make_asteroid(vector_t center) {
+  vector_t corners[] = {{0, 0},
+                        {BENCH_ASTEROID_SIZE.x, 0},
+                        {BENCH_ASTEROID_SIZE.x, BENCH_ASTEROID_SIZE.y},
+                        {0, BENCH_ASTEROID_SIZE.y}};
+  list_t *points = list_init(4, free);
+  for (size_t i = 0; i < 4; i++) {
+    vector_t *v = malloc(sizeof(vector_t));
+    assert(v);
+    *v = corners[i];
+    list_add(points, v);
+  }
+  body_t *asteroid = body_init(points, 1, (rgb_color_t){0, 0, 0});
+  body_set_centroid(asteroid, center);
+  return asteroid;
+}
+
+/**
+ * Runs find_collision() on a pair of bodies `iterations` times
+ * and prints the number of pairs tested per second.
+ */
+static void bench_pair(const char *name, body_t *body1, body_t *body2,
+                       size_t iterations) {
+  size_t collided = 0;
+  uint64_t start = timer_now_ns();
+  for (size_t i = 0; i < iterations; i++) {
+    collided += find_collision(body1, body2).collided;
+  }
+  double elapsed = (double)(timer_now_ns() - start) / NS_PER_S;
+  printf("%-24s %12.0f pairs/s  (%s)\n", name, iterations / elapsed,
+         collided ? "colliding" : "separate");
+}
+
+int main(int argc, char *argv[]) {
+  size_t iterations = argc > 1 ? strtoul(argv[1], NULL, 10) : DEFAULT_ITERATIONS;
+
+  body_t *ship1 = make_ship((vector_t){100, 100});
+  body_t *ship2 = make_ship((vector_t){120, 100});
+  body_t *far_ship = make_ship((vector_t){900, 400});
+  body_t *asteroid = make_asteroid((vector_t){130, 110});
+  body_t *far_asteroid = make_asteroid((vector_t){600, 50});
+
+  bench_pair("ship x ship", ship1, ship2, iterations);
+  bench_pair("ship x ship (far)", ship1, far_ship, iterations);
+  bench_pair("ship x asteroid", ship1, asteroid, iterations);
+  bench_pair("ship x asteroid (far)", ship1, far_asteroid, iterations);
+
+  body_free(ship1);
+  body_free(ship2);
+  body_free(far_ship);
+  body_free(asteroid);
+  body_free(far_asteroid);
+}
@@ -0,0 +1,129 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "body.h"
+#include "frame_timer.h"
+#include "shape.h"
+
+/**
+ * Compares ticking bodies one at a time with body_tick() against the batched
+ * body_arrays_integrate() loop scene_tick() uses, at several body counts.
+ *
+ * Usage: bin/integrate_bench [ticks]
+ */
+
+const size_t DEFAULT_TICKS = 100;
+const size_t BODY_COUNTS[] = {1000, 10000, 100000};
+const double BENCH_DT = 1.0 / 60;
+const double BENCH_BODY_RADIUS = 5;
+const size_t BENCH_BODY_POINTS = 4;
+
+static body_t **make_bodies(shape_t *shape, size_t num_bodies) {
+  body_t **bodies = malloc(sizeof(body_t *) * num_bodies);
+  assert(bodies);
+  for (size_t i = 0; i < num_bodies; i++) {
+    vector_t center = {(double)(i % 1000), (double)(i / 1000)};
+    bodies[i] = body_init_with_shape(shape, center, 1 + i % 3,
+                                     (rgb_color_t){0, 0, 0}, NULL, NULL, 0);
+    body_set_velocity(bodies[i], (vector_t){1, (double)(i % 7)});
+    body_set_rotation_speed(bodies[i], i % 2);
+  }
+  return bodies;
+}
+
+/** Applies the same force every tick, like a force creator would */
+static void add_forces(body_t **bodies, size_t num_bodies) {
+  for (size_t i = 0; i < num_bodies; i++) {
+    body_add_force(bodies[i], (vector_t){0, -1});
+  }
+}
+
+static void free_bodies(body_t **bodies, size_t num_bodies) {
+  for (size_t i = 0; i < num_bodies; i++) {
+    body_free(bodies[i]);
+  }
+  free(bodies);
+}
+
+static body_arrays_t arrays_init(size_t num_bodies) {
+  body_arrays_t arrays = {
+      malloc(sizeof(vector_t) * num_bodies), malloc(sizeof(vector_t) * num_bodies),
+      malloc(sizeof(vector_t) * num_bodies), malloc(sizeof(vector_t) * num_bodies),
+      malloc(sizeof(double) * num_bodies),   malloc(sizeof(double) * num_bodies),
+      malloc(sizeof(double) * num_bodies),   malloc(sizeof(vector_t) * num_bodies),
+      malloc(sizeof(double) * num_bodies)};
+  assert(arrays.position && arrays.velocity && arrays.force && arrays.impulse &&
+         arrays.inverse_mass && arrays.angle && arrays.angular_velocity &&
+         arrays.prev_position && arrays.prev_angle);
+  return arrays;
+}
+
+static void arrays_free(body_arrays_t arrays) {
+  free(arrays.position);
+  free(arrays.velocity);
+  free(arrays.force);
+  free(arrays.impulse);
+  free(arrays.inverse_mass);
+  free(arrays.angle);
+  free(arrays.angular_velocity);
+  free(arrays.prev_position);
+  free(arrays.prev_angle);
+}
+
+/**
+ * Prints the number of body updates per second, and a checksum of the final
+ * positions so both versions can be checked against each other.
+ */
+static void report(const char *name, size_t num_bodies, size_t ticks,
+                   double elapsed, body_t **bodies) {
+  double checksum = 0;
+  for (size_t i = 0; i < num_bodies; i++) {
+    vector_t centroid = body_get_centroid(bodies[i]);
+    checksum += centroid.x + centroid.y;
+  }
+  printf("%-10s %7zu bodies %12.0f bodies/s  (checksum %.6e)\n", name,
+         num_bodies, num_bodies * ticks / elapsed, checksum);
+}
+
+int main(int argc, char *argv[]) {
+  size_t ticks = argc > 1 ? strtoul(argv[1], NULL, 10) : DEFAULT_TICKS;
+  shape_registry_init();
+  shape_t *shape =
+      shape_get_regular_polygon(BENCH_BODY_POINTS, BENCH_BODY_RADIUS);
+
+  for (size_t c = 0; c < sizeof(BODY_COUNTS) / sizeof(BODY_COUNTS[0]); c++) {
+    size_t num_bodies = BODY_COUNTS[c];
+
+    body_t **bodies = make_bodies(shape, num_bodies);
+    double elapsed = 0;
+    for (size_t t = 0; t < ticks; t++) {
+      add_forces(bodies, num_bodies);
+      uint64_t start = timer_now_ns();
+      for (size_t i = 0; i < num_bodies; i++) {
+        body_tick(bodies[i], BENCH_DT);
+      }
+      elapsed += (double)(timer_now_ns() - start) / NS_PER_S;
+    }
+    report("body_tick", num_bodies, ticks, elapsed, bodies);
+    free_bodies(bodies, num_bodies);
+
+    bodies = make_bodies(shape, num_bodies);
+    body_arrays_t arrays = arrays_init(num_bodies);
+    for (size_t i = 0; i < num_bodies; i++) {
+      body_attach(bodies[i], &arrays, i);
+    }
+    elapsed = 0;
+    for (size_t t = 0; t < ticks; t++) {
+      add_forces(bodies, num_bodies);
+      uint64_t start = timer_now_ns();
+      body_arrays_integrate(&arrays, 0, num_bodies, BENCH_DT);
+      elapsed += (double)(timer_now_ns() - start) / NS_PER_S;
+    }
+    report("batched", num_bodies, ticks, elapsed, bodies);
+    free_bodies(bodies, num_bodies);
+    arrays_free(arrays);
+  }
+
+  shape_registry_destroy();
+}
@@ -0,0 +1,117 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "forces.h"
+#include "frame_timer.h"
+#include "scene.h"
+#include "shape.h"
+
+/**
+ * Measures how scene_tick() scales from 1 thread up to the number of cores,
+ * on a scene dominated by force creators (gravity between every pair of a few
+ * hundred bodies) and one dominated by integration (many bodies with drag).
+ * Checks that every thread count ends with bit-identical positions.
+ * Build with 'make NO_ASAN=true THREADS=true bin/scene_bench'; without
+ * THREADS, every thread count runs on one thread.
+ *
+ * Usage: bin/scene_bench [ticks] [max threads]
+ */
+
+const size_t DEFAULT_TICKS = 20;
+const size_t GRAVITY_BODIES = 512;
+const double BENCH_G = 1e3;
+const size_t DRAG_BODIES = 100000;
+const double BENCH_DRAG = 0.1;
+const double BENCH_DT = 1.0 / 60;
+const double BENCH_BODY_RADIUS = 5;
+const size_t BENCH_BODY_POINTS = 4;
+const double BENCH_SPACING = 20;
+
+typedef enum { GRAVITY_SCENE, DRAG_SCENE } bench_scene_t;
+
+static scene_t *make_scene(bench_scene_t kind, shape_t *shape) {
+  scene_t *scene = scene_init();
+  size_t num_bodies = kind == GRAVITY_SCENE ? GRAVITY_BODIES : DRAG_BODIES;
+  size_t row = kind == GRAVITY_SCENE ? 32 : 1000;
+  for (size_t i = 0; i < num_bodies; i++) {
+    vector_t center = {BENCH_SPACING * (i % row), BENCH_SPACING * (i / row)};
+    body_t *body = body_init_with_shape(shape, center, 1 + i % 3,
+                                        (rgb_color_t){0, 0, 0}, NULL, NULL, 0);
+    body_set_velocity(body, (vector_t){1, (double)(i % 7)});
+    scene_add_body(scene, body);
+    if (kind == DRAG_SCENE) {
+      create_drag(scene, BENCH_DRAG, body);
+    }
+  }
+  if (kind == GRAVITY_SCENE) {
+    for (size_t i = 0; i < num_bodies; i++) {
+      for (size_t j = i + 1; j < num_bodies; j++) {
+        create_newtonian_gravity(scene, BENCH_G, scene_get_body(scene, i),
+                                 scene_get_body(scene, j));
+      }
+    }
+  }
+  return scene;
+}
+
+/**
+ * Ticks a new scene on some number of threads.
+ * Stores the final positions in `positions` and returns ticks per second.
+ */
+static double run(bench_scene_t kind, shape_t *shape, size_t num_threads,
+                  size_t ticks, vector_t *positions) {
+  scene_t *scene = make_scene(kind, shape);
+  scene_set_num_threads(scene, num_threads);
+  list_t *assets = list_init(1, NULL);
+
+  uint64_t start = timer_now_ns();
+  for (size_t t = 0; t < ticks; t++) {
+    list_free(scene_tick(scene, assets, BENCH_DT));
+  }
+  double elapsed = (double)(timer_now_ns() - start) / NS_PER_S;
+
+  for (size_t i = 0; i < scene_bodies(scene); i++) {
+    positions[i] = body_get_centroid(scene_get_body(scene, i));
+  }
+  list_free(assets);
+  scene_free(scene);
+  return ticks / elapsed;
+}
+
+static void bench(const char *name, bench_scene_t kind, shape_t *shape,
+                  size_t ticks, size_t max_threads) {
+  size_t num_bodies = kind == GRAVITY_SCENE ? GRAVITY_BODIES : DRAG_BODIES;
+  vector_t *serial = malloc(sizeof(vector_t) * num_bodies);
+  vector_t *parallel = malloc(sizeof(vector_t) * num_bodies);
+  assert(serial && parallel);
+
+  printf("%s (%zu bodies)\n", name, num_bodies);
+  double serial_rate = run(kind, shape, 1, ticks, serial);
+  printf("  %2d threads %10.1f ticks/s  1.00x\n", 1, serial_rate);
+  for (size_t threads = 2; threads <= max_threads; threads++) {
+    double rate = run(kind, shape, threads, ticks, parallel);
+    bool identical =
+        memcmp(serial, parallel, sizeof(vector_t) * num_bodies) == 0;
+    printf("  %2zu threads %10.1f ticks/s  %.2fx%s\n", threads, rate,
+           rate / serial_rate, identical ? "" : "  MISMATCH");
+  }
+  free(serial);
+  free(parallel);
+}
+
+int main(int argc, char *argv[]) {
+  size_t ticks = argc > 1 ? strtoul(argv[1], NULL, 10) : DEFAULT_TICKS;
+  size_t max_threads =
+      argc > 2 ? strtoul(argv[2], NULL, 10) : sysconf(_SC_NPROCESSORS_ONLN);
+  shape_registry_init();
+  shape_t *shape =
+      shape_get_regular_polygon(BENCH_BODY_POINTS, BENCH_BODY_RADIUS);
+
+  bench("pairwise gravity", GRAVITY_SCENE, shape, ticks, max_threads);
+  bench("drag", DRAG_SCENE, shape, ticks, max_threads);
+
+  shape_registry_destroy();
+}
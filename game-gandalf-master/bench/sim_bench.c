@@ -0,0 +1,401 @@
+#include <assert.h>
+#include <getopt.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "forces.h"
+#include "frame_timer.h"
+#include "rng.h"
+#include "scene.h"
+#include "sdl_wrapper.h"
+#include "shape.h"
+
+/**
+ * Runs the game's physics headlessly: a scene of ships, asteroids, bullets
+ * and black holes with the game's collision rules and gravity, ticked a fixed
+ * number of times without ever opening a window or drawing anything.
+ * Prints ticks/s, body and pair counts and the time spent in each phase of
+ * scene_tick() as JSON, as a baseline to compare physics changes against.
+ * Bodies destroyed by collisions are replaced by new ones, so the scene keeps
+ * the same number of each kind of body for the whole run. Every random
+ * choice comes from the seed, so runs with the same options do the same work.
+ * With --render, every tick is also drawn with sdl_render_scene() on
+ * RENDER_BACKEND_NULL, which counts the draw calls instead of making them.
+ * Build with 'make NO_ASAN=true bin/sim_bench'.
+ *
+ * Usage: bin/sim_bench [--ticks N] [--ships N] [--asteroids N] [--bullets N]
+ *   [--black-holes N] [--seed N] [--threads N] [--render]
+ */
+
+const size_t DEFAULT_TICKS = 300;
+const size_t DEFAULT_SHIPS = 2;
+const size_t DEFAULT_ASTEROIDS = 300;
+const size_t DEFAULT_BULLETS = 300;
+const size_t DEFAULT_BLACK_HOLES = 4;
+const unsigned DEFAULT_SEED = 42;
+// the fixed tick length of the game
+const double SIM_DT = 1.0 / 120;
+// the arena grows with the number of bodies, so crowding stays the same
+const double AREA_PER_BODY = 1e4;
+const double ARENA_ASPECT = 2; // width / height, as in the game
+
+// the game's body sizes, masses, speeds and force constants
+const double SHIP_RADIUS = 15;
+const size_t SHIP_NUM_POINTS = 20;
+const double SHIP_MASS = 100;
+const double BULLET_RADIUS = 40;
+const size_t CIRC_NPOINTS = 4;
+const double BULLET_MASS = 100;
+const double BULLET_SPEED = 1000;
+const double ASTEROID_HEIGHT = 30;
+const vector_t ASTEROID_WIDTHS = {30, 70};
+const double ASTEROID_MASS = 100;
+const vector_t ASTEROID_SPEEDS = {100, 300};
+const double BLK_HOLE_RADIUS = 50;
+const double BLK_HOLE_MASS = 10000;
+const double BLK_HOLE_SPEED = 3;
+const double BLK_HOLE_GRAV = 1e2;
+const double BUL_ASTER_GRAV = 1e3;
+
+const rgb_color_t SIM_COLOR = {0, 0, 0};
+
+const char *SHIP_INFO = "Ship";
+const char *ASTEROID_INFO = "Asteroid";
+const char *BULLET_INFO = "Player Bullet";
+const char *BLK_HOLE_INFO = "Black Hole";
+
+// the game's collision categories
+const uint32_t SHIP1_CATEGORY = 1 << 0;
+const uint32_t SHIP2_CATEGORY = 1 << 1;
+const uint32_t RED_BULLET_CATEGORY = 1 << 2;
+const uint32_t BLU_BULLET_CATEGORY = 1 << 3;
+const uint32_t ASTEROID_CATEGORY = 1 << 4;
+const uint32_t ITEM_CATEGORY = 1 << 6;
+const uint32_t BLK_HOLE_CATEGORY = 1 << 7;
+
+typedef struct sim_options {
+  size_t ticks;
+  size_t ships;
+  size_t asteroids;
+  size_t bullets;
+  size_t black_holes;
+  unsigned seed;
+  size_t threads;
+  bool render;
+} sim_options_t;
+
+typedef struct sim {
+  scene_t *scene;
+  vector_t arena;
+  // ship handles, to fire replacement bullets from
+  body_handle_t *ships;
+  size_t num_ships;
+  rng_t rng;
+} sim_t;
+
+static vector_t rand_position(sim_t *sim) {
+  return (vector_t){rng_range(&sim->rng, 0, sim->arena.x),
+                    rng_range(&sim->rng, 0, sim->arena.y)};
+}
+
+static vector_t rand_velocity(sim_t *sim, double speed) {
+  double angle = rng_range(&sim->rng, 0, 2 * M_PI);
+  return (vector_t){speed * cos(angle), speed * sin(angle)};
+}
+
+static body_t *make_ship(sim_t *sim, size_t index) {
+  shape_t *shape = shape_get_regular_polygon(SHIP_NUM_POINTS, SHIP_RADIUS);
+  body_t *ship = body_init_with_shape(shape, rand_position(sim), SHIP_MASS,
+                                      SIM_COLOR, (void *)SHIP_INFO, NULL, 0);
+  body_set_category(ship, index % 2 == 0 ? SHIP1_CATEGORY : SHIP2_CATEGORY);
+  return ship;
+}
+
+static body_t *make_asteroid(sim_t *sim) {
+  double width = rng_range(&sim->rng, ASTEROID_WIDTHS.x, ASTEROID_WIDTHS.y);
+  body_t *asteroid = body_init_with_shape(
+      shape_get_rectangle(width, ASTEROID_HEIGHT), rand_position(sim),
+      ASTEROID_MASS, SIM_COLOR, (void *)ASTEROID_INFO, NULL, 0);
+  body_set_category(asteroid, ASTEROID_CATEGORY);
+  double speed = rng_range(&sim->rng, ASTEROID_SPEEDS.x, ASTEROID_SPEEDS.y);
+  body_set_velocity(asteroid, rand_velocity(sim, speed));
+  body_set_rotation_speed(asteroid, rng_range(&sim->rng, 0, M_PI / 2));
+  return asteroid;
+}
+
+/**
+ * Fires a bullet in a random direction from a random ship, in the colour of
+ * that ship, or from a random position if there are no ships.
+ */
+static body_t *make_bullet(sim_t *sim) {
+  vector_t center = rand_position(sim);
+  uint32_t category = RED_BULLET_CATEGORY;
+  if (sim->num_ships > 0) {
+    size_t index = rng_below(&sim->rng, sim->num_ships);
+    body_t *ship = scene_get_body_by_handle(sim->scene, sim->ships[index]);
+    center = body_get_centroid(ship);
+    category = index % 2 == 0 ? RED_BULLET_CATEGORY : BLU_BULLET_CATEGORY;
+  }
+  shape_t *shape = shape_get_regular_polygon(CIRC_NPOINTS, BULLET_RADIUS);
+  body_t *bullet = body_init_with_shape(shape, center, BULLET_MASS, SIM_COLOR,
+                                        (void *)BULLET_INFO, NULL, 0);
+  body_set_category(bullet, category);
+  body_set_velocity(bullet, rand_velocity(sim, BULLET_SPEED));
+  return bullet;
+}
+
+static body_t *make_black_hole(sim_t *sim) {
+  shape_t *shape = shape_get_regular_polygon(CIRC_NPOINTS, BLK_HOLE_RADIUS);
+  body_t *black_hole =
+      body_init_with_shape(shape, rand_position(sim), BLK_HOLE_MASS, SIM_COLOR,
+                           (void *)BLK_HOLE_INFO, NULL, 0);
+  body_set_category(black_hole, ITEM_CATEGORY | BLK_HOLE_CATEGORY);
+  body_set_velocity(black_hole, rand_velocity(sim, BLK_HOLE_SPEED));
+  return black_hole;
+}
+
+/**
+ * Replaces a body that is about to be removed with a new one of its kind.
+ */
+static void replace_body(sim_t *sim, body_t *body) {
+  if (body_is_removed(body)) {
+    return;
+  }
+  body_remove(body);
+  if (body_get_info(body) == ASTEROID_INFO) {
+    scene_queue_add_body(sim->scene, make_asteroid(sim));
+  } else {
+    scene_queue_add_body(sim->scene, make_bullet(sim));
+  }
+}
+
+/**
+ * Like the game's bullet-asteroid, ship-asteroid and ship-bullet handlers,
+ * minus the score keeping: body2, and body1 too if it is a bullet,
+ * is destroyed.
+ */
+static void destroy_collision_handler(body_t *body1, body_t *body2,
+                                      vector_t axis, void *aux,
+                                      double force_const) {
+  sim_t *sim = aux;
+  if (body_get_info(body1) == BULLET_INFO) {
+    replace_body(sim, body1);
+  }
+  replace_body(sim, body2);
+}
+
+/**
+ * Wraps bodies that left the arena around to the other side,
+ * like the game does to asteroids, so none of them are lost off the edges.
+ */
+static void wrap_edges(sim_t *sim) {
+  for (size_t i = 0; i < scene_bodies(sim->scene); i++) {
+    body_t *body = scene_get_body(sim->scene, i);
+    vector_t centroid = body_get_centroid(body);
+    vector_t wrapped = {fmod(centroid.x + sim->arena.x, sim->arena.x),
+                        fmod(centroid.y + sim->arena.y, sim->arena.y)};
+    if (wrapped.x != centroid.x || wrapped.y != centroid.y) {
+      body_set_centroid(body, wrapped);
+    }
+  }
+}
+
+static void sim_init(sim_t *sim, sim_options_t *options) {
+  size_t num_bodies = options->ships + options->asteroids + options->bullets +
+                      options->black_holes;
+  double height = sqrt(AREA_PER_BODY * num_bodies / ARENA_ASPECT);
+  sim->arena = (vector_t){ARENA_ASPECT * height, height};
+  sim->rng = rng_init(options->seed, 0);
+  sim->scene = scene_init();
+  scene_set_num_threads(sim->scene, options->threads);
+  sim->num_ships = options->ships;
+  sim->ships = malloc(sizeof(body_handle_t) * (options->ships + 1));
+  assert(sim->ships);
+
+  scene_t *scene = sim->scene;
+  scene_add_collision_rule(scene, RED_BULLET_CATEGORY | BLU_BULLET_CATEGORY,
+                           ASTEROID_CATEGORY, destroy_collision_handler, sim,
+                           0);
+  scene_add_collision_rule(scene, SHIP2_CATEGORY, RED_BULLET_CATEGORY,
+                           destroy_collision_handler, sim, 0);
+  scene_add_collision_rule(scene, SHIP1_CATEGORY, BLU_BULLET_CATEGORY,
+                           destroy_collision_handler, sim, 0);
+  scene_add_collision_rule(scene, SHIP1_CATEGORY | SHIP2_CATEGORY,
+                           ASTEROID_CATEGORY, destroy_collision_handler, sim,
+                           0);
+  create_category_newtonian_gravity(scene, BUL_ASTER_GRAV,
+                                    RED_BULLET_CATEGORY | BLU_BULLET_CATEGORY,
+                                    ASTEROID_CATEGORY);
+  create_category_newtonian_gravity(scene, BLK_HOLE_GRAV, BLK_HOLE_CATEGORY,
+                                    ASTEROID_CATEGORY);
+
+  for (size_t i = 0; i < options->ships; i++) {
+    sim->ships[i] = scene_add_body(scene, make_ship(sim, i));
+  }
+  for (size_t i = 0; i < options->asteroids; i++) {
+    scene_add_body(scene, make_asteroid(sim));
+  }
+  for (size_t i = 0; i < options->bullets; i++) {
+    scene_add_body(scene, make_bullet(sim));
+  }
+  for (size_t i = 0; i < options->black_holes; i++) {
+    scene_add_body(scene, make_black_hole(sim));
+  }
+}
+
+static void sim_free(sim_t *sim) {
+  scene_free(sim->scene);
+  free(sim->ships);
+}
+
+static double ms_per_tick(uint64_t ns, size_t ticks) {
+  return ticks > 0 ? ns / 1e6 / ticks : 0;
+}
+
+static void print_results(sim_options_t *options, sim_t *sim, size_t bodies,
+                          uint64_t total_ns, uint64_t edges_ns,
+                          uint64_t render_ns) {
+  scene_stats_t stats = scene_get_stats(sim->scene);
+  double seconds = total_ns / 1e9;
+  size_t ticks = stats.ticks;
+  printf("{\n");
+  printf("  \"ticks\": %zu,\n", ticks);
+  printf("  \"threads\": %zu,\n", options->threads);
+  printf("  \"seed\": %u,\n", options->seed);
+  printf("  \"dt\": %g,\n", SIM_DT);
+  printf("  \"arena\": [%.0f, %.0f],\n", sim->arena.x, sim->arena.y);
+  printf("  \"bodies\": %zu,\n", bodies);
+  printf("  \"ships\": %zu,\n", options->ships);
+  printf("  \"asteroids\": %zu,\n", options->asteroids);
+  printf("  \"bullets\": %zu,\n", options->bullets);
+  printf("  \"black_holes\": %zu,\n", options->black_holes);
+  printf("  \"seconds\": %.6f,\n", seconds);
+  printf("  \"ticks_per_sec\": %.1f,\n", seconds > 0 ? ticks / seconds : 0);
+  printf("  \"pairs_tested\": %zu,\n", stats.pairs_tested);
+  printf("  \"pairs_per_tick\": %.1f,\n",
+         ticks > 0 ? (double)stats.pairs_tested / ticks : 0);
+  printf("  \"collisions\": %zu,\n", stats.collisions);
+  if (options->render) {
+    render_counts_t counts = render_null_get_counts();
+    printf("  \"draw_calls\": {\"frames\": %zu, \"triangle_batches\": %zu, "
+           "\"triangles\": %zu, \"triangle_vertices\": %zu, "
+           "\"textures\": %zu},\n",
+           counts.frames, counts.triangle_batches, counts.triangles,
+           counts.triangle_vertices, counts.textures);
+  }
+  printf("  \"ms_per_tick\": {\n");
+  printf("    \"broadphase\": %.4f,\n", ms_per_tick(stats.broadphase_ns, ticks));
+  printf("    \"force_creators\": %.4f,\n",
+         ms_per_tick(stats.force_creators_ns, ticks));
+  printf("    \"narrowphase\": %.4f,\n",
+         ms_per_tick(stats.narrowphase_ns, ticks));
+  printf("    \"collision_handlers\": %.4f,\n",
+         ms_per_tick(stats.handlers_ns, ticks));
+  printf("    \"commands\": %.4f,\n", ms_per_tick(stats.commands_ns, ticks));
+  printf("    \"integration\": %.4f,\n", ms_per_tick(stats.integrate_ns, ticks));
+  printf("    \"wrap_edges\": %.4f,\n", ms_per_tick(edges_ns, ticks));
+  printf("    \"render\": %.4f,\n", ms_per_tick(render_ns, ticks));
+  printf("    \"total\": %.4f\n", ms_per_tick(total_ns, ticks));
+  printf("  }\n");
+  printf("}\n");
+}
+
+static void usage(const char *program) {
+  fprintf(stderr,
+          "Usage: %s [--ticks N] [--ships N] [--asteroids N] [--bullets N]\n"
+          "  [--black-holes N] [--seed N] [--threads N] [--render]\n",
+          program);
+  exit(1);
+}
+
+static void parse_options(int argc, char *argv[], sim_options_t *options) {
+  static const struct option long_options[] = {
+      {"ticks", required_argument, NULL, 't'},
+      {"ships", required_argument, NULL, 's'},
+      {"asteroids", required_argument, NULL, 'a'},
+      {"bullets", required_argument, NULL, 'b'},
+      {"black-holes", required_argument, NULL, 'k'},
+      {"seed", required_argument, NULL, 'r'},
+      {"threads", required_argument, NULL, 'j'},
+      {"render", no_argument, NULL, 'd'},
+      {NULL, 0, NULL, 0}};
+  *options = (sim_options_t){DEFAULT_TICKS,       DEFAULT_SHIPS,
+                             DEFAULT_ASTEROIDS,   DEFAULT_BULLETS,
+                             DEFAULT_BLACK_HOLES, DEFAULT_SEED,
+                             1,                   false};
+  int opt;
+  while ((opt = getopt_long(argc, argv, "", long_options, NULL)) != -1) {
+    size_t value = optarg != NULL ? strtoul(optarg, NULL, 10) : 0;
+    switch (opt) {
+    case 't':
+      options->ticks = value;
+      break;
+    case 's':
+      options->ships = value;
+      break;
+    case 'a':
+      options->asteroids = value;
+      break;
+    case 'b':
+      options->bullets = value;
+      break;
+    case 'k':
+      options->black_holes = value;
+      break;
+    case 'r':
+      options->seed = value;
+      break;
+    case 'j':
+      options->threads = value > 0 ? value : 1;
+      break;
+    case 'd':
+      options->render = true;
+      break;
+    default:
+      usage(argv[0]);
+    }
+  }
+  if (optind < argc) {
+    usage(argv[0]);
+  }
+}
+
+int main(int argc, char *argv[]) {
+  sim_options_t options;
+  parse_options(argc, argv, &options);
+  shape_registry_init();
+
+  sim_t sim;
+  sim_init(&sim, &options);
+  size_t bodies = scene_bodies(sim.scene);
+  // never drawn, but scene_tick() removes the assets of removed bodies
+  list_t *assets = list_init(1, NULL);
+  if (options.render) {
+    sdl_set_render_backend(&RENDER_BACKEND_NULL);
+    sdl_init((vector_t){0, 0}, sim.arena);
+  }
+
+  uint64_t edges_ns = 0;
+  uint64_t render_ns = 0;
+  uint64_t start = timer_now_ns();
+  for (size_t t = 0; t < options.ticks; t++) {
+    list_free(scene_tick(sim.scene, assets, SIM_DT));
+    uint64_t edges_start = timer_now_ns();
+    wrap_edges(&sim);
+    uint64_t render_start = timer_now_ns();
+    edges_ns += render_start - edges_start;
+    if (options.render) {
+      sdl_render_scene(sim.scene, NULL);
+      render_ns += timer_now_ns() - render_start;
+    }
+  }
+  uint64_t total_ns = timer_now_ns() - start;
+  assert(scene_bodies(sim.scene) == bodies);
+
+  print_results(&options, &sim, bodies, total_ns, edges_ns, render_ns);
+  list_free(assets);
+  sim_free(&sim);
+  shape_registry_destroy();
+}
@@ -10,8 +10,10 @@
 #include "collision.h"
 #include "forces.h"
 #include "player.h"
+#include "rng.h"
 #include "screen.h"
 #include "sdl_wrapper.h"
+#include "shape.h"
 const uint8_t NUM_SCREENS = 2;
 const uint8_t OP_SCREEN_IDX = 0;
 const uint8_t GAME_SCREEN_IDX = 1;
@@ -45,6 +47,10 @@ const double EVENT_SPAWN_TIME = 20.0;  // seconds between pot. events
 const double CHANCE_EVENT_SPAWN = 1.0; // % chance that event spawn // old: 0.2
 const double ASTEROID_SPAWN_TIME = 2.0;
 
+// the physics runs at a fixed rate, so fast bullets don't tunnel on slow frames
+const double PHYSICS_DT = 1.0 / 120;
+const size_t MAX_PHYSICS_SUBSTEPS = 8;
+
 const int8_t BUL_DMG_TO_PLAYER = -10;
 const int8_t ASTER_DMG_TO_PLAYER = -20;
 
@@ -128,10 +134,24 @@ const char *PWRUP_INFO = "Pwrup";
 const char *EVENT_INFO = "Event";
 const char *METAL_INFO = "Metal";
 
+// collision categories, see body_set_category()
+const uint32_t SHIP1_CATEGORY = 1 << 0;
+const uint32_t SHIP2_CATEGORY = 1 << 1;
+const uint32_t RED_BULLET_CATEGORY = 1 << 2;
+const uint32_t BLU_BULLET_CATEGORY = 1 << 3;
+const uint32_t ASTEROID_CATEGORY = 1 << 4;
+const uint32_t METAL_CATEGORY = 1 << 5;
+const uint32_t ITEM_CATEGORY = 1 << 6;
+const uint32_t BLK_HOLE_CATEGORY = 1 << 7;
+
 const char *HEALTH_SYSTEM_INFO = "Health";
 const char *POINTS_SYSTEM_INFO = "Points";
 const char *BULL_SYSTEM_INFO = "Bullets";
 
+// the RNG streams of the game's systems, see rng_init()
+const uint64_t SPAWN_STREAM = 0;
+const uint64_t PWRUP_STREAM = 1;
+
 typedef struct dead_aster {
   double dt;
   int change_num;
@@ -194,6 +214,8 @@ struct state {
 
   body_t *shippy1;
   body_t *shippy2;
+  body_handle_t shippy1_handle;
+  body_handle_t shippy2_handle;
   list_t *dead_asters;
 
   asset_t *shoot_sfx;
@@ -201,6 +223,9 @@ struct state {
   double pwrup_delta_t;    // time since last powerup
   double event_delta_t;    // time since last event
   double asteroid_delta_t; // time since last asteroid
+
+  rng_t spawn_rng; // asteroids
+  rng_t pwrup_rng; // powerups and events
 };
 
 void next_screen(state_t *state) {
@@ -208,93 +233,60 @@ void next_screen(state_t *state) {
   state->screen_idx = state->screen_idx % list_size(state->screens);
 }
 
-double rand_double(double low, double high) {
-  return (high - low) * rand() / RAND_MAX + low;
-}
-
-void rand_boundary_loc(vector_t *center, double *dir_angle) {
-  double rand = ceil(rand_double(0, 4));
+void rand_boundary_loc(rng_t *rng, vector_t *center, double *dir_angle) {
+  uint32_t side = rng_below(rng, 4);
+  // x, y, and how far through the side's half turn of directions to head
+  double uniform[3];
+  rng_fill_doubles(rng, uniform, 3);
 
-  double random_x = rand_double(MIN.x, MAX.x);
-  double random_y = rand_double(MIN.y, MAX.y);
+  double random_x = MIN.x + (MAX.x - MIN.x) * uniform[0];
+  double random_y = MIN.y + (MAX.y - MIN.y) * uniform[1];
+  double half_turn = M_PI * uniform[2];
 
-  if (rand == 1.0) { // spawn at y = MIN.y -> angle in [0, pi]
+  if (side == 0) { // spawn at y = MIN.y -> angle in [0, pi]
     *center = (vector_t){random_x, MIN.y};
-    *dir_angle = rand_double(0, M_PI);
-  } else if (rand == 2.0) { // spawn at x = MAX.x -> angle in [pi/2, 3pi/2]
+    *dir_angle = half_turn;
+  } else if (side == 1) { // spawn at x = MAX.x -> angle in [pi/2, 3pi/2]
     *center = (vector_t){MAX.x, random_y};
-    *dir_angle = rand_double(M_PI / 2, 3 * M_PI / 2);
-  } else if (rand == 3.0) { // spawn at y = MAX.y -> angle in [pi, 2pi]
+    *dir_angle = M_PI / 2 + half_turn;
+  } else if (side == 2) { // spawn at y = MAX.y -> angle in [pi, 2pi]
     *center = (vector_t){random_x, MAX.y};
-    *dir_angle = rand_double(M_PI, 2 * M_PI);
+    *dir_angle = M_PI + half_turn;
   } else { // spawn at x = MIN.x -> angle in [-pi/2, pi/2]
     *center = (vector_t){MIN.x, random_y};
-    *dir_angle = rand_double(-M_PI / 2, M_PI / 2);
+    *dir_angle = -M_PI / 2 + half_turn;
   }
 }
 
 body_t *make_obstacle(size_t w, size_t h, vector_t center, double mass,
                       void *info) {
-  list_t *c = list_init(4, free);
-  vector_t *v1 = malloc(sizeof(vector_t));
-  assert(v1);
-  v1->x = 0;
-  v1->y = 0;
-  list_add(c, v1);
-
-  vector_t *v2 = malloc(sizeof(vector_t));
-  assert(v2);
-  v2->x = w;
-  v2->y = 0;
-  list_add(c, v2);
-
-  vector_t *v3 = malloc(sizeof(vector_t));
-  assert(v3);
-  v3->x = w;
-  v3->y = h;
-  list_add(c, v3);
-
-  vector_t *v4 = malloc(sizeof(vector_t));
-  assert(v4);
-  v4->x = 0;
-  v4->y = h;
-  list_add(c, v4);
-
-  body_t *obstacle = body_init_with_info(c, mass, BLACK_COLOR, info, NULL, 0);
-  body_set_centroid(obstacle, center);
-  return obstacle;
+  return body_init_with_shape(shape_get_rectangle(w, h), center, mass,
+                              BLACK_COLOR, info, NULL, 0);
 }
 
 body_t *make_spaceship(vector_t center, player_t *info) {
   center.y += PLAYER_RADIUS;
-  list_t *c = list_init(SHIP_NUM_POINTS, free);
-  for (size_t i = 0; i < SHIP_NUM_POINTS; i++) {
-    double angle = 2 * M_PI * i / SHIP_NUM_POINTS;
-    vector_t *v = malloc(sizeof(vector_t));
-    assert(v);
-    v->x = center.x + PLAYER_RADIUS * cos(angle);
-    v->y = center.y + PLAYER_RADIUS * sin(angle);
-    list_add(c, v);
-  }
-  body_t *shippy = body_init_with_info(c, SHIP_MASS, BLACK_COLOR, info,
-                                       (free_func_t)player_free, 0);
+  shape_t *shape = shape_get_regular_polygon(SHIP_NUM_POINTS, PLAYER_RADIUS);
+  body_t *shippy = body_init_with_shape(shape, center, SHIP_MASS, BLACK_COLOR,
+                                        info, (free_func_t)player_free, 0);
   return shippy;
 }
 
-body_t *make_asteroid() {
+body_t *make_asteroid(rng_t *rng) {
   vector_t pos;
   double dir;
-  rand_boundary_loc(&pos, &dir);
+  rand_boundary_loc(rng, &pos, &dir);
 
-  double w = rand_double(OBS_WIDTHS.x, OBS_WIDTHS.y);
+  double w = rng_range(rng, OBS_WIDTHS.x, OBS_WIDTHS.y);
   body_t *asteroid =
       make_obstacle(w, OBSTACLE_HEIGHT, pos, ASTEROID_MASS, ASTEROID_INFO);
+  body_set_category(asteroid, ASTEROID_CATEGORY);
 
-  double aster_speed = rand_double(ASTER_SPEEDS.x, ASTER_SPEEDS.y);
+  double aster_speed = rng_range(rng, ASTER_SPEEDS.x, ASTER_SPEEDS.y);
   vector_t vel = create_vector(aster_speed, dir);
   body_set_velocity(asteroid, vel);
 
-  double rotation_speed = rand_double(0, M_PI / 2);
+  double rotation_speed = rng_range(rng, 0, M_PI / 2);
   body_set_rotation_speed(asteroid, rotation_speed);
 
   return asteroid;
@@ -311,37 +303,32 @@ body_t *make_asteroid() {
  */
 body_t *make_body(vector_t center, double radius, double mass, double dir_angle,
                   rgb_color_t color, void *info) {
-  list_t *c = list_init(CIRC_NPOINTS, free);
-  for (size_t i = 0; i < CIRC_NPOINTS; i++) {
-    double angle = 2 * M_PI * i / CIRC_NPOINTS;
-    vector_t *v = malloc(sizeof(vector_t));
-    assert(v);
-    *v = (vector_t){center.x + radius * cos(angle),
-                    center.y + radius * sin(angle)};
-    list_add(c, v);
-  }
-  return body_init_with_info(c, mass, color, info, NULL, dir_angle);
+  shape_t *shape = shape_get_regular_polygon(CIRC_NPOINTS, radius);
+  return body_init_with_shape(shape, center, mass, color, info, NULL,
+                              dir_angle);
 }
 
-body_t *make_bullet(vector_t center, double angle, char *info) {
+body_t *make_bullet(vector_t center, double angle, char *info,
+                    uint32_t category) {
   body_t *bullet =
       make_body(center, BULLET_RADIUS, BULLET_MASS, angle, BLACK_COLOR, info);
+  body_set_category(bullet, category);
 
   vector_t bull_vel = create_vector(BULLET_SPEED, M_PI / 2 - angle);
   body_set_velocity(bullet, bull_vel);
   return bullet;
 }
 
-body_t *make_powerup() {
+body_t *make_powerup(rng_t *rng) {
   vector_t center;
   double angle;
-  rand_boundary_loc(&center, &angle);
+  rand_boundary_loc(rng, &center, &angle);
 
   char *info;
-  double pwrup_choice = ceil(rand_double(0, 3));
-  if (pwrup_choice == 1.0) {
+  uint32_t pwrup_choice = rng_below(rng, 3);
+  if (pwrup_choice == 0) {
     info = SPEED_PWRUP_PATH;
-  } else if (pwrup_choice == 2.0) {
+  } else if (pwrup_choice == 1) {
     info = HEALTH_PWRUP_PATH;
   } else {
     info = DAMAGE_PWRUP_PATH;
@@ -355,11 +342,11 @@ body_t *make_powerup() {
   return pwrup;
 }
 
-body_t *make_random_physics_event() {
+body_t *make_random_physics_event(rng_t *rng) {
   char *info;
-  double event_choice = rand_double(0, 1);
+  double event_choice = rng_double(rng);
   double radius;
-  if (event_choice <= 0.5) {
+  if (event_choice < 0.5) {
     info = BLK_HOLE_PATH;
     radius = BLK_HOLE_RADIUS;
   } else {
@@ -369,7 +356,7 @@ body_t *make_random_physics_event() {
 
   vector_t center;
   double angle;
-  rand_boundary_loc(&center, &angle);
+  rand_boundary_loc(rng, &center, &angle);
 
   body_t *event = make_body(center, radius, EVENT_MASS, 0, BLACK_COLOR, info);
 
@@ -399,14 +386,11 @@ void user_wrap_edges(body_t *player) {
 }
 
 void delete_if_on_edge(body_t *body) {
-  vector_t centroid = body_get_centroid(body);
   polygon_t *poly = body_get_polygon(body);
-  list_t *vectors = polygon_get_points(poly);
-  vector_t *vertex_zero = list_get(vectors, 0);
-  double radius = vec_get_length(vec_subtract(*vertex_zero, centroid));
+  vector_t min = polygon_get_bounds_min(poly);
+  vector_t max = polygon_get_bounds_max(poly);
 
-  if (centroid.y - radius >= MAX.y || centroid.y + radius <= MIN.y ||
-      centroid.x - radius >= MAX.x || centroid.x + radius <= MIN.x) {
+  if (min.y >= MAX.y || max.y <= MIN.y || min.x >= MAX.x || max.x <= MIN.x) {
     body_remove(body);
   }
 }
@@ -446,10 +430,13 @@ void player_bullet_collision_handler(body_t *body1, body_t *body2,
   body_remove(body2);
 }
 
-void create_player_bullet_collision(scene_t *scene, body_t *player,
-                                    body_t *bullet) {
-  create_collision(scene, player, bullet, player_bullet_collision_handler, NULL,
-                   BUL_DMG_TO_PLAYER);
+void create_player_bullet_collisions(scene_t *scene) {
+  scene_add_collision_rule(scene, SHIP2_CATEGORY, RED_BULLET_CATEGORY,
+                           player_bullet_collision_handler, NULL,
+                           BUL_DMG_TO_PLAYER);
+  scene_add_collision_rule(scene, SHIP1_CATEGORY, BLU_BULLET_CATEGORY,
+                           player_bullet_collision_handler, NULL,
+                           BUL_DMG_TO_PLAYER);
 }
 
 void bullet_asteroid_collision_handler(body_t *body1, body_t *body2,
@@ -468,10 +455,10 @@ void bullet_asteroid_collision_handler(body_t *body1, body_t *body2,
   }
 }
 
-void create_bullet_asteroid_collision(state_t *state, scene_t *scene,
-                                      body_t *body1, body_t *body2) {
-  create_collision(scene, body1, body2, bullet_asteroid_collision_handler,
-                   state, POINTS_FOR_ASTER);
+void create_bullet_asteroid_collisions(state_t *state, scene_t *scene) {
+  scene_add_collision_rule(scene, RED_BULLET_CATEGORY | BLU_BULLET_CATEGORY,
+                           ASTEROID_CATEGORY, bullet_asteroid_collision_handler,
+                           state, POINTS_FOR_ASTER);
 }
 
 void ship_aster_collision_handler(body_t *body1, body_t *body2, vector_t axis,
@@ -481,10 +468,10 @@ void ship_aster_collision_handler(body_t *body1, body_t *body2, vector_t axis,
   player_change_health(player, force_const);
 }
 
-void create_ship_aster_collision(scene_t *scene, body_t *shippy,
-                                 body_t *asteroid) {
-  create_collision(scene, shippy, asteroid, ship_aster_collision_handler, NULL,
-                   ASTER_DMG_TO_PLAYER);
+void create_ship_aster_collisions(scene_t *scene) {
+  scene_add_collision_rule(scene, SHIP1_CATEGORY | SHIP2_CATEGORY,
+                           ASTEROID_CATEGORY, ship_aster_collision_handler,
+                           NULL, ASTER_DMG_TO_PLAYER);
 }
 
 void on_key(char key, key_event_type_t type, double held_time, state_t *state) {
@@ -492,8 +479,13 @@ void on_key(char key, key_event_type_t type, double held_time, state_t *state) {
   scene_t *game_screen_scene = screen_get_scene(game_screen);
   list_t *game_screen_assets = screen_get_body_assets(game_screen);
 
-  body_t *shippy1 = scene_get_body(game_screen_scene, 0);
-  body_t *shippy2 = scene_get_body(game_screen_scene, 1);
+  body_t *shippy1 =
+      scene_get_body_by_handle(game_screen_scene, state->shippy1_handle);
+  body_t *shippy2 =
+      scene_get_body_by_handle(game_screen_scene, state->shippy2_handle);
+  if (shippy1 == NULL || shippy2 == NULL) {
+    return;
+  }
 
   vector_t curr_vel_1 = body_get_velocity(shippy1);
   double curr_rot_1 = body_get_direction_angle(shippy1);
@@ -537,10 +529,10 @@ void on_key(char key, key_event_type_t type, double held_time, state_t *state) {
       }
       char *p1_bul_path = player_get_bullet_path(player1);
       vector_t shippy1_center = body_get_centroid(shippy1);
-      body_t *user1_bullet =
-          make_bullet(shippy1_center, curr_rot_1, p1_bul_path);
+      body_t *user1_bullet = make_bullet(shippy1_center, curr_rot_1,
+                                         p1_bul_path, RED_BULLET_CATEGORY);
 
-      scene_add_body(game_screen_scene, user1_bullet);
+      scene_queue_add_body(game_screen_scene, user1_bullet);
 
       asset_t *bullet1_asset =
           asset_make_image_with_body(p1_bul_path, user1_bullet);
@@ -550,24 +542,6 @@ void on_key(char key, key_event_type_t type, double held_time, state_t *state) {
       player_increment_bullets_shot(player1, 1);
 
       asset_play_sfx(state->shoot_sfx, 80);
-
-      for (size_t i = 0; i < scene_bodies(game_screen_scene); i++) {
-        body_t *obstacle = scene_get_body(game_screen_scene, i);
-        void *info = body_get_info(obstacle);
-        // add bullet magnetism here...
-        if (info == ASTEROID_INFO) {
-          create_bullet_asteroid_collision(state, game_screen_scene,
-                                           user1_bullet, obstacle);
-          create_newtonian_gravity(game_screen_scene, BUL_ASTER_GRAV,
-                                   user1_bullet, obstacle);
-        } else if (info == player2) {
-          create_player_bullet_collision(game_screen_scene, obstacle,
-                                         user1_bullet);
-        } else if (info == METAL_INFO) {
-          create_one_sided_destructive_collision(game_screen_scene, obstacle,
-                                                 user1_bullet);
-        }
-      }
       break;
     }
     case LEFT_ARROW: // cc for player2
@@ -597,10 +571,10 @@ void on_key(char key, key_event_type_t type, double held_time, state_t *state) {
       }
       char *p2_bul_path = player_get_bullet_path(player2);
       vector_t shippy2_center = body_get_centroid(shippy2);
-      body_t *user2_bullet =
-          make_bullet(shippy2_center, curr_rot_2, p2_bul_path);
+      body_t *user2_bullet = make_bullet(shippy2_center, curr_rot_2,
+                                         p2_bul_path, BLU_BULLET_CATEGORY);
 
-      scene_add_body(game_screen_scene, user2_bullet);
+      scene_queue_add_body(game_screen_scene, user2_bullet);
 
       asset_t *bullet2_asset =
           asset_make_image_with_body(p2_bul_path, user2_bullet);
@@ -610,26 +584,6 @@ void on_key(char key, key_event_type_t type, double held_time, state_t *state) {
       player_increment_bullets_shot(player2, 1);
 
       asset_play_sfx(state->shoot_sfx, 80);
-
-      for (size_t i = 0; i < scene_bodies(game_screen_scene); i++) {
-        body_t *obstacle = scene_get_body(game_screen_scene, i);
-        void *info = body_get_info(obstacle);
-        // add bullet magnetism here...
-        if (info == ASTEROID_INFO) {
-          create_bullet_asteroid_collision(state, game_screen_scene,
-                                           user2_bullet, obstacle);
-          create_newtonian_gravity(game_screen_scene, BUL_ASTER_GRAV,
-                                   user2_bullet, obstacle);
-        }
-        if (info == player1) {
-          create_player_bullet_collision(game_screen_scene, obstacle,
-                                         user2_bullet);
-        }
-        if (info == METAL_INFO) {
-          create_one_sided_destructive_collision(game_screen_scene, obstacle,
-                                                 user2_bullet);
-        }
-      }
       break;
     }
     }
@@ -652,7 +606,8 @@ void ship_item_collision_handler(body_t *shippy, body_t *item, vector_t axis,
   char *ship_info = player_get_name(player);
   if (info == HEALTH_PWRUP_PATH) {
     // increase player health somehow
-    ssize_t health_amt = rand_double(HEALTH_DELTA.x, HEALTH_DELTA.y);
+    ssize_t health_amt =
+        rng_range(&state->pwrup_rng, HEALTH_DELTA.x, HEALTH_DELTA.y);
     player_change_health(player, health_amt);
   } else if (info == SPEED_PWRUP_PATH) {
     // bump up player speed multiplier
@@ -689,15 +644,10 @@ void ship_item_collision_handler(body_t *shippy, body_t *item, vector_t axis,
   body_remove(item);
 }
 
-void create_item_collision(state_t *state, scene_t *scene, body_t *body,
-                           body_t *item) {
-  player_t *player = body_get_info(body);
-  char *player_name = player_get_name(player);
-
-  if (player_name == PLAYER1_NAME || player_name == PLAYER2_NAME) {
-    create_collision(scene, body, item, ship_item_collision_handler, state, 0);
-    return;
-  }
+void create_item_collisions(state_t *state, scene_t *scene) {
+  scene_add_collision_rule(scene, SHIP1_CATEGORY | SHIP2_CATEGORY,
+                           ITEM_CATEGORY, ship_item_collision_handler, state,
+                           0);
 }
 
 /**
@@ -713,35 +663,27 @@ void add_item(state_t *state, char *info) {
   body_t *body;
   const char *body_path;
   if (info == PWRUP_INFO) {
-    body = make_powerup();
+    body = make_powerup(&state->pwrup_rng);
     body_path = body_get_info(body);
   } else if (info == EVENT_INFO) {
-    body = make_random_physics_event();
+    body = make_random_physics_event(&state->pwrup_rng);
     body_path = body_get_info(body);
   } else {
     return;
   }
+  uint32_t category = ITEM_CATEGORY;
+  if (body_path == BLK_HOLE_PATH) {
+    category |= BLK_HOLE_CATEGORY;
+  }
+  body_set_category(body, category);
   screen_t *screen = list_get(state->screens, state->screen_idx);
   scene_t *scene = screen_get_scene(screen);
   list_t *assets = screen_get_body_assets(screen);
 
-  scene_add_body(scene, body);
+  scene_queue_add_body(scene, body);
 
   asset_t *body_asset = asset_make_image_with_body(body_path, body);
   list_add(assets, body_asset);
-
-  body_t *shippy1 = state->shippy1;
-  body_t *shippy2 = state->shippy2;
-  create_item_collision(state, scene, shippy1, body);
-  create_item_collision(state, scene, shippy2, body);
-  if (body_path == BLK_HOLE_PATH) {
-    for (size_t i = 0; i < scene_bodies(scene); i++) {
-      body_t *scene_body = scene_get_body(scene, i);
-      if (body_get_info(scene_body) == ASTEROID_INFO) {
-        create_newtonian_gravity(scene, BLK_HOLE_GRAV, body, scene_body);
-      }
-    }
-  }
 }
 
 body_t *add_asteroid(state_t *state) {
@@ -749,13 +691,9 @@ body_t *add_asteroid(state_t *state) {
   scene_t *scene = screen_get_scene(screen);
   list_t *assets = screen_get_body_assets(screen);
 
-  body_t *shippy1 = scene_get_body(scene, 0);
-  body_t *shippy2 = scene_get_body(scene, 1);
-  body_t *aster = make_asteroid();
+  body_t *aster = make_asteroid(&state->spawn_rng);
 
-  scene_add_body(scene, aster);
-  create_ship_aster_collision(scene, shippy1, aster);
-  create_ship_aster_collision(scene, shippy2, aster);
+  scene_queue_add_body(scene, aster);
   asset_t *asteroid_asset = asset_make_image_with_body(ASTEROID_PATH, aster);
   list_add(assets, asteroid_asset);
 
@@ -867,7 +805,7 @@ void update_score_display(player_t *player, asset_t *assets) {
                         health_bounding_box.x, health_bounding_box.y,
                         health_bounding_box.w, health_bounding_box.h, idx);
 
-    list_set(assets, new_health_asset, idx);
+    asset_destroy(list_set(assets, new_health_asset, idx));
     player_change_displayed_health(player, player_health);
   }
 
@@ -888,7 +826,7 @@ void update_score_display(player_t *player, asset_t *assets) {
         make_text_asset(points_str, assets, POINTS_SYSTEM_INFO,
                         points_bounding_box.x, points_bounding_box.y,
                         points_bounding_box.w, points_bounding_box.h, idx);
-    list_set(assets, new_points_asset, idx);
+    asset_destroy(list_set(assets, new_points_asset, idx));
 
     player_change_displayed_points(player, player_points);
   }
@@ -909,7 +847,7 @@ void update_score_display(player_t *player, asset_t *assets) {
     asset_t *new_bull_asset = make_text_asset(
         bull_str, assets, BULL_SYSTEM_INFO, bull_bounding_box.x,
         bull_bounding_box.y, bull_bounding_box.w, bull_bounding_box.h, idx);
-    list_set(assets, new_bull_asset, idx);
+    asset_destroy(list_set(assets, new_bull_asset, idx));
 
     player_change_displayed_bull(player, player_bull);
   }
@@ -930,7 +868,37 @@ bool game_is_over(state_t *state) {
 
 state_t *emscripten_init() {
   asset_cache_init();
+  shape_registry_init();
   sdl_init(MIN, MAX);
+  // pack every sprite into a few shared textures up front
+  const char *sprite_paths[] = {
+      BLU_SPACESHIP_PATH,
+      RED_SPACESHIP_PATH,
+      BLU_GHOST_SHIPPY_PATH,
+      RED_GHOST_SHIPPY_PATH,
+      ASTEROID_PATH,
+      BACKGROUND_PATH,
+      LOGO_PATH,
+      STARTBTN_PATH,
+      BLU_DMG_BULLET_PATH,
+      RED_DMG_BULLET_PATH,
+      POINTS_PATH,
+      BLU_BULLET_PATH,
+      RED_BULLET_PATH,
+      SPEED_PWRUP_PATH,
+      HEALTH_PWRUP_PATH,
+      DAMAGE_PWRUP_PATH,
+      BLK_HOLE_PATH,
+      TIME_DIL_PATH,
+      HORIZ_METAL_PATH,
+      VERT_METAL_PATH,
+      EXPLOSION1_PATH,
+      EXPLOSION2_PATH,
+      EXPLOSION3_PATH,
+      EXPLOSION4_PATH,
+  };
+  asset_cache_pack_images(sprite_paths,
+                          sizeof(sprite_paths) / sizeof(sprite_paths[0]));
   state_t *state = malloc(sizeof(state_t));
   assert(state);
 
@@ -945,7 +913,9 @@ state_t *emscripten_init() {
 
   state->screen_idx = 0;
 
-  srand(time(NULL));
+  uint32_t seed = sdl_get_seed();
+  state->spawn_rng = rng_init(seed, SPAWN_STREAM);
+  state->pwrup_rng = rng_init(seed, PWRUP_STREAM);
 
   // op screen's scene & assets
   screen_t *op_screen = list_get(state->screens, OP_SCREEN_IDX);
@@ -986,13 +956,15 @@ state_t *emscripten_init() {
   // both ships
   body_t *shippy1 = make_spaceship(VEC_ZERO, player1);
   body_t *shippy2 = make_spaceship(VEC_ZERO, player2);
+  body_set_category(shippy1, SHIP1_CATEGORY);
+  body_set_category(shippy2, SHIP2_CATEGORY);
   state->shippy1 = shippy1;
   state->shippy2 = shippy2;
   body_set_centroid(shippy1, P1_RESET_POS);
   body_set_centroid(shippy2, P2_RESET_POS);
 
-  scene_add_body(game_scene, shippy1);
-  scene_add_body(game_scene, shippy2);
+  state->shippy1_handle = scene_add_body(game_scene, shippy1);
+  state->shippy2_handle = scene_add_body(game_scene, shippy2);
 
   asset_t *ship1_asset =
       asset_make_image_with_body(RED_SPACESHIP_PATH, shippy1);
@@ -1001,6 +973,20 @@ state_t *emscripten_init() {
   list_add(game_assets, ship1_asset);
   list_add(game_assets, ship2_asset);
 
+  // collisions and forces between whole categories of bodies, so spawning a
+  // body only has to set its category
+  create_bullet_asteroid_collisions(state, game_scene);
+  create_player_bullet_collisions(game_scene);
+  create_ship_aster_collisions(game_scene);
+  create_item_collisions(state, game_scene);
+  create_category_one_sided_destructive_collision(
+      game_scene, METAL_CATEGORY, RED_BULLET_CATEGORY | BLU_BULLET_CATEGORY);
+  create_category_newtonian_gravity(game_scene, BUL_ASTER_GRAV,
+                                    RED_BULLET_CATEGORY | BLU_BULLET_CATEGORY,
+                                    ASTEROID_CATEGORY);
+  create_category_newtonian_gravity(game_scene, BLK_HOLE_GRAV,
+                                    BLK_HOLE_CATEGORY, ASTEROID_CATEGORY);
+
   // asteroids
   for (size_t r = 0; r < INIT_NUM_ASTEROIDS; r++) {
     add_asteroid(state);
@@ -1011,6 +997,8 @@ state_t *emscripten_init() {
                                  INFINITY, METAL_INFO);
   body_t *metal2 = make_obstacle(METAL_WIDTH, METAL_HEIGHT, METAL2_POS,
                                  INFINITY, METAL_INFO);
+  body_set_category(metal1, METAL_CATEGORY);
+  body_set_category(metal2, METAL_CATEGORY);
   scene_add_body(game_scene, metal1);
   scene_add_body(game_scene, metal2);
   asset_t *metal1_asset = asset_make_image_with_body(VERT_METAL_PATH, metal1);
@@ -1120,17 +1108,8 @@ bool emscripten_main(state_t *state) {
 
     if (state->asteroid_delta_t >= ASTEROID_SPAWN_TIME) {
       state->asteroid_delta_t = 0;
-      body_t *aster1 = add_asteroid(state);
-      body_t *aster2 = add_asteroid(state);
-      for (size_t i = 0; i < scene_bodies(scene); i++) {
-        body_t *maybe_blk_hole = scene_get_body(scene, i);
-        if (body_get_info(maybe_blk_hole) == BLK_HOLE_PATH) {
-          create_newtonian_gravity(scene, BLK_HOLE_GRAV, aster1,
-                                   maybe_blk_hole);
-          create_newtonian_gravity(scene, BLK_HOLE_GRAV, aster2,
-                                   maybe_blk_hole);
-        }
-      }
+      add_asteroid(state);
+      add_asteroid(state);
     }
 
     update_score_display(player1, assets);
@@ -1138,8 +1117,7 @@ bool emscripten_main(state_t *state) {
 
     if (state->event_delta_t >= EVENT_SPAWN_TIME) {
       state->event_delta_t = 0;
-      double rand = rand_double(0, 1);
-      if (rand < CHANCE_EVENT_SPAWN) {
+      if (rng_double(&state->pwrup_rng) < CHANCE_EVENT_SPAWN) {
         add_item(state, EVENT_INFO);
       }
     }
@@ -1173,6 +1151,7 @@ bool emscripten_main(state_t *state) {
     }
   }
 
+  sdl_set_interpolation(scene_get_interpolation_alpha(scene));
   sdl_clear();
   for (size_t i = 0; i < list_size(assets); i++) {
     asset_t *asset = list_get(assets, i);
@@ -1182,7 +1161,9 @@ bool emscripten_main(state_t *state) {
   }
   sdl_show();
 
-  list_t *aster_pos = scene_tick(scene, assets, dt);
+  list_t *aster_pos = scene_step_fixed(scene, assets, dt, PHYSICS_DT,
+                                       MAX_PHYSICS_SUBSTEPS);
+  sdl_track_scene(scene);
 
   for (size_t i = 0; i < list_size(aster_pos); i++) {
     vector_t *pos = list_get(aster_pos, i);
@@ -1190,7 +1171,7 @@ bool emscripten_main(state_t *state) {
 
     body_t *body = make_obstacle((OBS_WIDTHS.x + OBS_WIDTHS.y) / 2,
                                  OBSTACLE_HEIGHT, new_pos, 1, DEAD_ASTER_INFO);
-    scene_add_body(scene, body);
+    scene_queue_add_body(scene, body);
     asset_t *asset = asset_make_image_with_body(EXPLOSION1_PATH, body);
     list_add(assets, asset);
 
@@ -1209,5 +1190,6 @@ void emscripten_free(state_t *state) {
   list_free(state->screens);
   list_free(state->dead_asters);
   asset_cache_destroy();
+  shape_registry_destroy();
   free(state);
 }
\ No newline at end of file
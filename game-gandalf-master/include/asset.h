@@ -50,7 +50,9 @@ asset_t *asset_make_image_with_body(const char *filepath, body_t *body);
  * @param filepath the filepath to the .ttf file
  * @param bounding_box the bounding box containing the location and dimensions
  * of the text when it is rendered
- * @param text the text to render
+ * @param text the text to render. It is drawn from the font's glyph atlas,
+ *   or if it has characters the atlas lacks, rasterized into a texture the
+ *   first time the asset is rendered and again only when its contents change.
  * @param color the color of the text
  * @return a pointer to the newly allocated text asset
  */
@@ -137,7 +139,7 @@ char *asset_get_text(asset_t *asset);
 SDL_Rect asset_get_bounding_box(asset_t *asset);
 
 /**
- * Frees the memory allocated for the asset.
+ * Frees the memory allocated for the asset, including a text asset's texture.
  * @param asset the asset to free
  */
 void asset_destroy(asset_t *asset);
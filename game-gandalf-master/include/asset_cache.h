@@ -5,8 +5,8 @@
 #include <stddef.h>
 
 /**
- * Initializes the empty, list-based global asset cache. The caller must then
- * destroy the cache with `asset_cache_destroy` when done.
+ * Initializes the empty global asset cache, a hash table keyed by filepath.
+ * The caller must then destroy the cache with `asset_cache_destroy` when done.
  */
 void asset_cache_init();
 
@@ -20,12 +20,14 @@ void asset_cache_destroy();
  * If the object exists, asserts that its type matches the given type.
  *
  * If the object doesn't exist, adds a new entry to the asset cache and returns
- * the pointer to the newly created object.
+ * the pointer to the newly created object. The cache keeps its own copy of the
+ * filepath, so the caller's string doesn't have to outlive the call.
+ * Takes constant expected time, however many assets are cached.
  *
  * Example:
  * ```
  * char *img_path = "assets/image.png";
- * SDL_Texture *obj = asset_cache_obj_get_or_create(ASSET_IMAGE, img_path);
+ * sprite_t *obj = asset_cache_obj_get_or_create(ASSET_IMAGE, img_path);
  *
  * char *font_path = "assets/font.ttf";
  * TTF_Font *obj = asset_cache_obj_get_or_create(ASSET_FONT, font_path);
@@ -33,10 +35,30 @@ void asset_cache_destroy();
  *
  * @param ty the type of the asset
  * @param filepath the filepath to the asset
- * @return the object that corresponds to the filepath, as a void*
+ * @return the object that corresponds to the filepath, as a void*; for
+ *   ASSET_IMAGE, a sprite_t * owned by the cache
  */
 void *asset_cache_obj_get_or_create(asset_type_t ty, const char *filepath);
 
+/**
+ * Loads images and packs them into a few shared textures, see
+ * sprite_atlas_build(). asset_cache_obj_get_or_create() then hands out their
+ * regions of those textures, so they can be drawn without switching
+ * textures. An image that was never packed gets a texture of its own when
+ * it is first asked for. Images that are already cached are left as they are.
+ *
+ * @param filepaths the filepaths of the images
+ * @param num_paths the number of images
+ */
+void asset_cache_pack_images(const char **filepaths, size_t num_paths);
+
+/**
+ * Gets the number of assets loaded into the asset cache, not counting buttons.
+ *
+ * @return the number of cached assets
+ */
+size_t asset_cache_size();
+
 /**
  * Registers the button to the asset cache, effectively activating its button
  * handler. When this function is called, the asset_cache takes ownership of the
@@ -0,0 +1,25 @@
+#ifndef __ATLAS_PACK_H__
+#define __ATLAS_PACK_H__
+
+#include <SDL2/SDL.h>
+#include <stddef.h>
+
+#include "sprite_atlas.h"
+
+/**
+ * Packs images onto as few textures ("pages") as possible: tallest first
+ * onto shelves, on pages of at most 4096x4096 pixels. An image too big for
+ * a page gets a page of its own. Frees the images once they are uploaded.
+ *
+ * @param images the images to pack, any of which may be NULL
+ * @param num_images the number of images
+ * @param sprites where to store each image's page and where it is on it;
+ *   a NULL image gets a NULL texture and an empty region
+ * @param num_pages where to store the number of pages
+ * @return the pages, which the caller must free, after destroying each
+ *   with sdl_destroy_texture()
+ */
+SDL_Texture **atlas_pack_images(SDL_Surface **images, size_t num_images,
+                                sprite_t *sprites, size_t *num_pages);
+
+#endif // #ifndef __ATLAS_PACK_H__
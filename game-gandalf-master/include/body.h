@@ -3,6 +3,7 @@
 
 #include <math.h>
 #include <stdbool.h>
+#include <stdint.h>
 
 #include "color.h"
 #include "list.h"
@@ -14,6 +15,43 @@
  */
 typedef struct body body_t;
 
+// a force creator stored in a scene, see forces.h
+struct fcreator_storer;
+
+/**
+ * Structure-of-arrays storage for the state that body_tick() integrates.
+ * A scene keeps the bodies it contains in one of these, so that it can
+ * integrate all of them in one loop with body_arrays_integrate().
+ * Each array is indexed by a body's slot.
+ */
+typedef struct body_arrays {
+  /** The bodies' centroids */
+  vector_t *position;
+  vector_t *velocity;
+  /** The forces and impulses accumulated during the current tick */
+  vector_t *force;
+  vector_t *impulse;
+  /** 1 / mass, or 0 for bodies with infinite mass */
+  double *inverse_mass;
+  /** The direction angles (see body_get_direction_angle()) */
+  double *angle;
+  double *angular_velocity;
+  /**
+   * The positions and direction angles before the latest tick,
+   * for rendering in between ticks (see body_get_interpolated_centroid())
+   */
+  vector_t *prev_position;
+  double *prev_angle;
+} body_arrays_t;
+
+/**
+ * A record of the forces and impulses applied to bodies while it is active,
+ * so that force creators can run on several threads without writing to the
+ * bodies directly. Replaying logs in a fixed order adds up the same values in
+ * the same order as applying them directly, so the results are bit-identical.
+ */
+typedef struct force_log force_log_t;
+
 /**
  * Initializes a body without any info.
  * Acts like body_init_with_info() where info and info_freer are NULL and
@@ -40,6 +78,24 @@ body_t *body_init_with_info(list_t *shape, double mass, rgb_color_t color,
                             void *info, free_func_t info_freer,
                             double direction);
 
+/**
+ * Allocates memory for a body that uses a shared shape,
+ * like body_init_with_info() but without copying any vertices.
+ *
+ * @param shape the body's shape, e.g. from shape_get_regular_polygon().
+ *   Must outlive the body, which doesn't free it.
+ * @param centroid the initial position of the body's center of mass
+ * @param mass the mass of the body (if INFINITY, stops the body from moving)
+ * @param color the color of the body, used to draw it on the screen
+ * @param info additional information to associate with the body
+ * @param info_freer if non-NULL, a function call on the info to free it
+ * @param direction angle in radians of the direction body is facing
+ * @return a pointer to the newly allocated body
+ */
+body_t *body_init_with_shape(shape_t *shape, vector_t centroid, double mass,
+                             rgb_color_t color, void *info,
+                             free_func_t info_freer, double direction);
+
 /**
  * Releases the memory allocated for a body.
  *
@@ -67,6 +123,29 @@ list_t *body_get_shape(body_t *body);
  */
 vector_t body_get_centroid(body_t *body);
 
+/**
+ * Gets the position of a body's center of mass a fraction of the way through
+ * its latest tick, e.g. to render it smoothly between fixed-rate ticks
+ * (see scene_step_fixed()).
+ * Moving a body with body_set_centroid() skips the interpolation,
+ * so teleported bodies aren't drawn sliding across the scene.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @param alpha 0 for the position before the latest tick, 1 for the current
+ * @return the interpolated center of mass
+ */
+vector_t body_get_interpolated_centroid(body_t *body, double alpha);
+
+/**
+ * Gets a body's direction angle a fraction of the way through its latest
+ * tick, turning the short way around.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @param alpha 0 for the angle before the latest tick, 1 for the current
+ * @return the interpolated angle in radians
+ */
+double body_get_interpolated_direction_angle(body_t *body, double alpha);
+
 /**
  * Gets the current velocity of a body.
  *
@@ -171,6 +250,19 @@ void body_set_rotation(body_t *body, double angle);
  */
 void body_tick(body_t *body, double dt);
 
+/**
+ * Ticks every body stored in slots [start, end) of some arrays,
+ * exactly like calling body_tick() on each of them.
+ * The loop only touches the arrays, so the compiler can vectorize it.
+ *
+ * @param arrays the arrays the bodies are stored in
+ * @param start the first slot to tick
+ * @param end one past the last slot to tick
+ * @param dt the number of seconds elapsed since the last tick
+ */
+void body_arrays_integrate(body_arrays_t *arrays, size_t start, size_t end,
+                           double dt);
+
 /**
  * Applies a force to a body over the current tick.
  * If multiple forces are applied in the same tick, they should be added.
@@ -193,6 +285,42 @@ void body_add_force(body_t *body, vector_t force);
  */
 void body_add_impulse(body_t *body, vector_t impulse);
 
+/**
+ * Allocates an empty force log.
+ *
+ * @return the new force log
+ */
+force_log_t *force_log_init(void);
+
+/**
+ * Releases the memory allocated for a force log.
+ *
+ * @param log a pointer to a force log returned from force_log_init()
+ */
+void force_log_free(force_log_t *log);
+
+/**
+ * Makes body_add_force() and body_add_impulse() on the calling thread append
+ * to a force log instead of changing the bodies, until force_log_end().
+ *
+ * @param log a pointer to a force log returned from force_log_init()
+ */
+void force_log_begin(force_log_t *log);
+
+/**
+ * Makes body_add_force() and body_add_impulse() on the calling thread change
+ * the bodies directly again.
+ */
+void force_log_end(void);
+
+/**
+ * Applies the forces and impulses in a force log to their bodies,
+ * in the order they were logged, and empties the log.
+ *
+ * @param log a pointer to a force log returned from force_log_init()
+ */
+void force_log_apply(force_log_t *log);
+
 /**
  * Clear the forces and impulses on the body.
  *
@@ -227,4 +355,81 @@ bool body_is_removed(body_t *body);
  */
 double body_get_direction_angle(body_t *body);
 
+/**
+ * Returns the collision categories of a body.
+ * Bodies start with no categories (0).
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return a bitmask with one bit set per category the body belongs to
+ */
+uint32_t body_get_category(body_t *body);
+
+/**
+ * Sets the collision categories of a body.
+ * The scene uses these to look up which collision rules apply to a pair of
+ * bodies; see scene_add_collision_rule().
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @param category a bitmask with one bit set per category
+ */
+void body_set_category(body_t *body, uint32_t category);
+
+/**
+ * Records that a force creator acts on a body, so the scene can find the
+ * force creators to remove when the body is removed without searching all of
+ * them. Called by scene_add_bodies_force_creator().
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @param storer the stored force creator that acts on the body
+ */
+void body_add_force_creator(body_t *body, struct fcreator_storer *storer);
+
+/**
+ * Forgets a force creator recorded with body_add_force_creator().
+ * Does nothing if it was not recorded.
+ * The order of the remaining force creators may change.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @param storer the stored force creator to forget
+ */
+void body_remove_force_creator(body_t *body, struct fcreator_storer *storer);
+
+/**
+ * Gets the number of force creators recorded as acting on a body.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return the number of force creators
+ */
+size_t body_num_force_creators(body_t *body);
+
+/**
+ * Gets a force creator recorded as acting on a body.
+ * Asserts that the index is valid.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @param index the index of the force creator (starting at 0)
+ * @return the stored force creator
+ */
+struct fcreator_storer *body_get_force_creator(body_t *body, size_t index);
+
+/**
+ * Moves a body's dynamic state into a slot of some arrays, so they become the
+ * body's storage from now on. Used by scene_add_body().
+ * Until a body is attached, it keeps its state in arrays of its own.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @param arrays the arrays to store the body in
+ * @param slot the index in the arrays to store the body at
+ */
+void body_attach(body_t *body, body_arrays_t *arrays, size_t slot);
+
+/**
+ * Tells an attached body that its state was moved to another slot of the
+ * same arrays, e.g. when the scene compacts them after removing bodies.
+ *
+ * @param body a pointer to a body attached with body_attach()
+ * @param slot the body's new index in the arrays
+ */
+void body_set_slot(body_t *body, size_t slot);
+
 #endif // #ifndef __BODY_H__
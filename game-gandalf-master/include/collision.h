@@ -22,6 +22,20 @@ typedef struct {
   vector_t axis;
 } collision_info_t;
 
+/**
+ * A function called when a collision occurs.
+ * @param body1 the first body passed to create_collision(), or the body in
+ *   the first category of a scene_add_collision_rule() rule
+ * @param body2 the second body passed to create_collision(), or the body in
+ *   the second category of a scene_add_collision_rule() rule
+ * @param axis a unit vector pointing from body1 towards body2
+ *   that defines the direction the two bodies are colliding in
+ * @param aux the auxiliary value passed to create_collision()
+ * @param force_const the force constant passed to create_collision()
+ */
+typedef void (*collision_handler_t)(body_t *body1, body_t *body2, vector_t axis,
+                                    void *aux, double force_const);
+
 /**
  * Computes the status of the collision between two bodies.
  *
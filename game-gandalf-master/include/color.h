@@ -3,6 +3,8 @@
 
 #include <stdbool.h>
 
+#include "rng.h"
+
 typedef struct color {
   double r;
   double g;
@@ -22,9 +24,11 @@ rgb_color_t *color_init(double red, double green, double blue);
 /**
  * Randomly generate rgb values for color of polygon.
  *
+ * @param rng the generator to draw from, e.g. a cosmetic stream of rng_init()
+ *   so that picking colors doesn't change the game's spawns
  * @return a pointer to a color object with randomly generated rgb values
  */
-rgb_color_t *color_get_random();
+rgb_color_t *color_get_random(rng_t *rng);
 
 /**
  * Compare the rgb values of two color structs.
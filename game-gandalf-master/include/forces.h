@@ -4,18 +4,6 @@
 #include "collision.h"
 #include "scene.h"
 
-/**
- * A function called when a collision occurs.
- * @param body1 the first body passed to create_collision()
- * @param body2 the second body passed to create_collision()
- * @param axis a unit vector pointing from body1 towards body2
- *   that defines the direction the two bodies are colliding in
- * @param aux the auxiliary value passed to create_collision()
- * @param force_const the force constant passed to create_collision()
- */
-typedef void (*collision_handler_t)(body_t *body1, body_t *body2, vector_t axis,
-                                    void *aux, double force_const);
-
 /**
  * Stores a force creator and its aux
  */
@@ -55,6 +43,43 @@ void *fcreator_storer_get_aux(fcreator_storer_t *storer);
  */
 list_t *fcreator_storer_get_bodies(fcreator_storer_t *storer);
 
+/**
+ * Marks a stored force creator for removal. The scene frees it at the end of
+ * the tick, like a body marked with body_remove().
+ *
+ * @param storer a pointer to an fcreator_storer returned from
+ * fcreator_storer_init
+ */
+void fcreator_storer_remove(fcreator_storer_t *storer);
+
+/**
+ * Returns whether a stored force creator has been marked for removal.
+ *
+ * @param storer a pointer to an fcreator_storer returned from
+ * fcreator_storer_init
+ * @return whether fcreator_storer_remove() has been called on it
+ */
+bool fcreator_storer_is_removed(fcreator_storer_t *storer);
+
+/**
+ * Marks a stored force creator as one that must run on the thread calling
+ * scene_tick(), see scene_add_serial_force_creator().
+ *
+ * @param storer a pointer to an fcreator_storer returned from
+ * fcreator_storer_init
+ */
+void fcreator_storer_set_serial(fcreator_storer_t *storer);
+
+/**
+ * Returns whether a stored force creator must run on the thread calling
+ * scene_tick().
+ *
+ * @param storer a pointer to an fcreator_storer returned from
+ * fcreator_storer_init
+ * @return whether fcreator_storer_set_serial() has been called on it
+ */
+bool fcreator_storer_is_serial(fcreator_storer_t *storer);
+
 /**
  * Gets the stored force creator.
  *
@@ -80,6 +105,23 @@ force_creator_t fcreator_storer_get_creator(fcreator_storer_t *storer);
 void create_newtonian_gravity(scene_t *scene, double G, body_t *body1,
                               body_t *body2);
 
+/**
+ * Adds a single force creator to a scene that applies Newtonian gravity
+ * between every body in category1 and every body in category2,
+ * as create_newtonian_gravity() would for each such pair.
+ * If the categories overlap, a pair of bodies that are both in both
+ * categories feels the force once, not once per order.
+ * Bodies join and leave the force just by being added to or removed from the
+ * scene, so nothing has to be registered per body.
+ *
+ * @param scene the scene containing the bodies
+ * @param G the gravitational proportionality constant
+ * @param category1 a bitmask of the categories of the first bodies
+ * @param category2 a bitmask of the categories of the second bodies
+ */
+void create_category_newtonian_gravity(scene_t *scene, double G,
+                                       uint32_t category1, uint32_t category2);
+
 /**
  * The force creator for gravitational forces between objects. Calculates
  * the magnitude of the force components and adds the force to each
@@ -194,6 +236,18 @@ static void one_sided_destructive_collision_handler(body_t *body1,
 void create_one_sided_destructive_collision(scene_t *scene, body_t *body1,
                                             body_t *body2);
 
+/**
+ * Adds a collision rule to a scene that destroys the category2 body whenever
+ * it collides with a category1 body. See scene_add_collision_rule().
+ *
+ * @param scene the scene containing the bodies
+ * @param category1 a bitmask of the categories of the surviving bodies
+ * @param category2 a bitmask of the categories of the destroyed bodies
+ */
+void create_category_one_sided_destructive_collision(scene_t *scene,
+                                                     uint32_t category1,
+                                                     uint32_t category2);
+
 /**
  * The collision handler for physics collisions. Applies impulses to
  * bodies according to the elasticity in `aux`.
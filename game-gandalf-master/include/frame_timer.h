@@ -0,0 +1,73 @@
+#ifndef __FRAME_TIMER_H__
+#define __FRAME_TIMER_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * The number of nanoseconds in a second, e.g. to convert timer_now_ns()
+ * differences to seconds.
+ */
+extern const uint64_t NS_PER_S;
+
+/**
+ * A rolling history of the most recent frame times.
+ */
+typedef struct frame_stats frame_stats_t;
+
+/**
+ * Summary statistics of the frame times in a frame_stats_t, in seconds.
+ */
+typedef struct frame_summary {
+  size_t count;
+  double mean;
+  double p50;
+  double p99;
+  double max;
+} frame_summary_t;
+
+/**
+ * Reads a monotonic wall clock with nanosecond resolution.
+ * Unlike clock(), this keeps counting while the process sleeps,
+ * e.g. waiting for vsync. Uses CLOCK_MONOTONIC natively
+ * and emscripten_get_now() in the browser.
+ *
+ * @return the time in nanoseconds since an arbitrary fixed point
+ */
+uint64_t timer_now_ns(void);
+
+/**
+ * Allocates an empty frame time history.
+ * Asserts that the required memory is allocated.
+ *
+ * @param capacity the number of most recent frames to keep
+ * @return the new history
+ */
+frame_stats_t *frame_stats_init(size_t capacity);
+
+/**
+ * Releases the memory allocated for a frame time history.
+ *
+ * @param stats a pointer to a history returned from frame_stats_init()
+ */
+void frame_stats_free(frame_stats_t *stats);
+
+/**
+ * Records the duration of a frame, replacing the oldest one once the history
+ * is full.
+ *
+ * @param stats a pointer to a history returned from frame_stats_init()
+ * @param seconds the duration of the frame
+ */
+void frame_stats_add(frame_stats_t *stats, double seconds);
+
+/**
+ * Computes the mean, median, 99th percentile and maximum of the frame times
+ * in a history. All of them are 0 if no frames have been recorded.
+ *
+ * @param stats a pointer to a history returned from frame_stats_init()
+ * @return the summary
+ */
+frame_summary_t frame_stats_summarize(frame_stats_t *stats);
+
+#endif // #ifndef __FRAME_TIMER_H__
@@ -0,0 +1,48 @@
+#ifndef __GLYPH_ATLAS_H__
+#define __GLYPH_ATLAS_H__
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_ttf.h>
+#include <stdbool.h>
+
+#include "color.h"
+
+/**
+ * The printable ASCII glyphs of a font, rasterized once into one texture.
+ * Text in that font is drawn as one batch of glyph quads cut from the
+ * texture, so changing the text (e.g. a score) rasterizes nothing and
+ * allocates no textures.
+ */
+typedef struct glyph_atlas glyph_atlas_t;
+
+/**
+ * Gets the atlas of a font, building it the first time the font is asked for.
+ * The atlases are owned by this module and live until
+ * glyph_atlas_destroy_all().
+ *
+ * @param font an opened font, or NULL
+ * @return the font's atlas, or NULL if the font is NULL
+ */
+glyph_atlas_t *glyph_atlas_get(TTF_Font *font);
+
+/**
+ * Draws a string stretched over a box, like a texture returned by
+ * sdl_load_text_texture() would be.
+ * Draws nothing if the string has a character that isn't in the atlas.
+ *
+ * @param atlas an atlas returned from glyph_atlas_get()
+ * @param text the string to draw
+ * @param box the box to stretch the string over
+ * @param color the color of the text, each channel in [0, 255]
+ * @return whether the string was drawn, i.e. all its characters are in
+ *   the atlas
+ */
+bool glyph_atlas_draw_text(glyph_atlas_t *atlas, const char *text,
+                           SDL_Rect box, rgb_color_t color);
+
+/**
+ * Frees every atlas and its texture. Must be called before closing the fonts.
+ */
+void glyph_atlas_destroy_all();
+
+#endif // #ifndef __GLYPH_ATLAS_H__
@@ -0,0 +1,147 @@
+#ifndef __INPUT_LOG_H__
+#define __INPUT_LOG_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * A recording of a match: the RNG seed, then everything the player did each
+ * frame and how long the frame took, interleaved with keyframes.
+ * Replaying the same frames with the same seed repeats the match exactly.
+ * Stored as a compact little-endian binary stream: a 16 byte header, 8 bytes
+ * per frame (12 with a click) and 17 bytes per keyframe.
+ */
+typedef struct input_log input_log_t;
+
+/**
+ * The bits of input_frame_t.keys, one per key sdl_is_done() polls.
+ */
+typedef enum {
+  INPUT_UP = 1 << 0,
+  INPUT_DOWN = 1 << 1,
+  INPUT_LEFT = 1 << 2,
+  INPUT_RIGHT = 1 << 3,
+  INPUT_W = 1 << 4,
+  INPUT_S = 1 << 5,
+  INPUT_A = 1 << 6,
+  INPUT_D = 1 << 7,
+  INPUT_M = 1 << 8,
+  INPUT_V = 1 << 9,
+} input_key_t;
+
+/**
+ * The input of one frame.
+ */
+typedef struct input_frame {
+  // the frame time returned by time_since_last_tick(), in nanoseconds
+  uint32_t dt_ns;
+  // the held keys, a bitmask of input_key_t
+  uint16_t keys;
+  // whether the mouse was clicked, at (click_x, click_y) in window pixels
+  bool clicked;
+  int16_t click_x;
+  int16_t click_y;
+} input_frame_t;
+
+/**
+ * A fingerprint of the game's scene after a frame's ticks,
+ * for checking that a replay still matches the recording.
+ */
+typedef struct keyframe {
+  uint32_t frame;
+  uint32_t num_bodies;
+  uint64_t digest; // see scene_digest()
+} keyframe_t;
+
+/**
+ * Starts recording a match to a file, overwriting it.
+ * The file is flushed at every keyframe, so a recording survives a crash,
+ * losing at most the frames since the last keyframe.
+ *
+ * @param path the file to record to
+ * @param seed the seed the match's RNG was seeded with
+ * @param keyframe_interval the number of frames between keyframes
+ * @return the new log, or NULL if the file couldn't be opened
+ */
+input_log_t *input_log_record(const char *path, uint32_t seed,
+                              uint32_t keyframe_interval);
+
+/**
+ * Reads a whole recording into memory to replay it.
+ *
+ * @param path a file written by a log returned from input_log_record()
+ * @return the recording, or NULL if the file couldn't be read or is not
+ *   a recording
+ */
+input_log_t *input_log_load(const char *path);
+
+/**
+ * Finishes writing a recording, or releases a loaded one.
+ *
+ * @param log a log returned from input_log_record() or input_log_load()
+ */
+void input_log_free(input_log_t *log);
+
+/**
+ * Gets the seed the recorded match's RNG was seeded with.
+ *
+ * @param log a log returned from input_log_record() or input_log_load()
+ * @return the seed
+ */
+uint32_t input_log_get_seed(input_log_t *log);
+
+/**
+ * Gets the number of frames between keyframes.
+ *
+ * @param log a log returned from input_log_record() or input_log_load()
+ * @return the keyframe interval
+ */
+uint32_t input_log_get_keyframe_interval(input_log_t *log);
+
+/**
+ * Appends a frame to a recording.
+ *
+ * @param log a log returned from input_log_record()
+ * @param frame the frame's input
+ */
+void input_log_add_frame(input_log_t *log, input_frame_t frame);
+
+/**
+ * Appends a keyframe to a recording.
+ *
+ * @param log a log returned from input_log_record()
+ * @param keyframe the fingerprint of the scene
+ */
+void input_log_add_keyframe(input_log_t *log, keyframe_t keyframe);
+
+/**
+ * Gets the number of frames in a loaded recording.
+ *
+ * @param log a log returned from input_log_load()
+ * @return the number of frames
+ */
+size_t input_log_num_frames(input_log_t *log);
+
+/**
+ * Gets a frame of a loaded recording.
+ * Asserts that the index is valid.
+ *
+ * @param log a log returned from input_log_load()
+ * @param index the index of the frame (starting at 0)
+ * @return the frame's input
+ */
+input_frame_t input_log_get_frame(input_log_t *log, size_t index);
+
+/**
+ * Looks up the keyframe recorded at a frame, in constant time.
+ *
+ * @param log a log returned from input_log_load()
+ * @param frame the index of the frame
+ * @param keyframe where to store the keyframe, if there is one
+ * @return whether a keyframe was recorded at that frame
+ */
+bool input_log_get_keyframe(input_log_t *log, size_t frame,
+                            keyframe_t *keyframe);
+
+#endif // #ifndef __INPUT_LOG_H__
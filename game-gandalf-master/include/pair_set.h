@@ -0,0 +1,65 @@
+#ifndef __PAIR_SET_H__
+#define __PAIR_SET_H__
+
+#include "body.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * A pair of bodies.
+ */
+typedef struct {
+  body_t *body1;
+  body_t *body2;
+} body_pair_t;
+
+/**
+ * A hash set of unordered body pairs, i.e. {a, b} and {b, a} are the same
+ * element. Meant to be cleared and refilled every tick, so it never shrinks
+ * and does not support removing single pairs.
+ */
+typedef struct pair_set pair_set_t;
+
+/**
+ * Allocates memory for an empty pair set.
+ * Asserts that the required memory is allocated.
+ *
+ * @return a pointer to the newly allocated pair set
+ */
+pair_set_t *pair_set_init(void);
+
+/**
+ * Releases the memory allocated for a pair set.
+ * Does not free the bodies.
+ *
+ * @param set a pointer to a pair set returned from pair_set_init()
+ */
+void pair_set_free(pair_set_t *set);
+
+/**
+ * Removes every pair from the set.
+ *
+ * @param set a pointer to a pair set returned from pair_set_init()
+ */
+void pair_set_clear(pair_set_t *set);
+
+/**
+ * Adds a pair to the set. Does nothing if the pair is already in it.
+ *
+ * @param set a pointer to a pair set returned from pair_set_init()
+ * @param body1 the first body
+ * @param body2 the second body
+ */
+void pair_set_add(pair_set_t *set, body_t *body1, body_t *body2);
+
+/**
+ * Returns whether a pair is in the set, in either order.
+ *
+ * @param set a pointer to a pair set returned from pair_set_init()
+ * @param body1 the first body
+ * @param body2 the second body
+ * @return whether {body1, body2} was added since the last pair_set_clear()
+ */
+bool pair_set_contains(pair_set_t *set, body_t *body1, body_t *body2);
+
+#endif // #ifndef __PAIR_SET_H__
@@ -3,14 +3,21 @@
 
 #include "color.h"
 #include "list.h"
+#include "shape.h"
 #include "vector.h"
+#include <stddef.h>
 
 typedef struct polygon polygon_t;
 
 /**
  * Initialize a polygon object given a list of vertices.
+ * The polygon stores its vertices as a shape relative to its centroid, along
+ * with a position and an angle, so moving or rotating it doesn't touch the
+ * vertices. The shape is private to this polygon; to share one between many
+ * polygons, use polygon_init_with_shape().
  *
- * @param points the list of vertices that make up the polygon
+ * @param points the list of vertices that make up the polygon.
+ * The polygon takes ownership of the list and frees it.
  * @param initial_position a vector representing the initial center position of
  * the polygon
  * @param initial_velocity a vector representing the initial velocity of the
@@ -26,14 +33,71 @@ polygon_t *polygon_init(list_t *points, vector_t initial_velocity,
                         double rotation_speed, double red, double green,
                         double blue);
 
+/**
+ * Initialize a polygon object that uses a shared shape.
+ *
+ * @param shape the polygon's shape, which must outlive the polygon.
+ * The polygon doesn't free it.
+ * @param centroid the initial position of the shape's centroid
+ * @param initial_velocity a vector representing the initial velocity of the
+ * polygon
+ * @param rotation_speed the rotation angle of the polygon per unit time
+ * @param red double value between 0 and 1 representing the red of the polygon
+ * @param green double value between 0 and 1 representing the green of the
+ * polygon
+ * @param blue double value between 0 and 1 representing the blue of the polygon
+ * @return a polygon object pointer
+ */
+polygon_t *polygon_init_with_shape(shape_t *shape, vector_t centroid,
+                                   vector_t initial_velocity,
+                                   double rotation_speed, double red,
+                                   double green, double blue);
+
 /**
  * Return the list of vectors representing the vertices of the polygon.
+ * The scene vertices are only recomputed when the polygon has moved since
+ * they were last asked for. The list is owned by the polygon and must not be
+ * modified; it reflects the polygon's position when it was returned.
  *
  * @param polygon the list of vertices that make up the polygon
  * @return a list of vectors
  */
 list_t *polygon_get_points(polygon_t *polygon);
 
+/**
+ * Returns the vertices of the polygon as a contiguous array,
+ * computed lazily like polygon_get_points().
+ * The array is owned by the polygon and is only valid until it moves.
+ *
+ * @param polygon a polygon_t struct
+ * @return the polygon's vertices in the scene, in counterclockwise order
+ */
+const vector_t *polygon_get_vertices(polygon_t *polygon);
+
+/**
+ * Returns the number of vertices of the polygon.
+ *
+ * @param polygon a polygon_t struct
+ * @return the number of vertices
+ */
+size_t polygon_num_vertices(polygon_t *polygon);
+
+/**
+ * Returns the local-space shape of the polygon.
+ *
+ * @param polygon a polygon_t struct
+ * @return the polygon's shape
+ */
+shape_t *polygon_get_shape(polygon_t *polygon);
+
+/**
+ * Returns the angle the polygon's shape is rotated by in the scene.
+ *
+ * @param polygon a polygon_t struct
+ * @return the angle in radians, counterclockwise
+ */
+double polygon_get_angle(polygon_t *polygon);
+
 /**
  * Translate and rotate the polygon then update velocity based on gravity.
  *
@@ -45,6 +109,7 @@ void polygon_move(polygon_t *polygon, double time_elapsed);
 /**
  * Computes the area of a polygon.
  * See https://en.wikipedia.org/wiki/Shoelace_formula#Statement.
+ * The area is computed once in polygon_init(), since moving doesn't change it.
  *
  * @param polygon the list of vertices that make up the polygon,
  * listed in a counterclockwise direction. There is an edge between
@@ -56,6 +121,7 @@ double polygon_area(polygon_t *polygon);
 /**
  * Computes the center of mass of a polygon.
  * See https://en.wikipedia.org/wiki/Centroid#Of_a_polygon.
+ * This is the position the polygon's local vertices are relative to.
  *
  * @param polygon the list of vertices that make up the polygon,
  * listed in a counterclockwise direction. There is an edge between
@@ -66,6 +132,7 @@ vector_t polygon_centroid(polygon_t *polygon);
 
 /**
  * Translates all vertices in a polygon by a given vector.
+ * Only the polygon's position changes, so this takes constant time.
  * Note: mutates the original polygon.
  *
  * @param polygon the list of vertices that make up the polygon
@@ -75,6 +142,7 @@ void polygon_translate(polygon_t *polygon, vector_t translation);
 
 /**
  * Rotates vertices in a polygon by a given angle about a given point.
+ * Only the polygon's position and angle change, so this takes constant time.
  * Note: mutates the original polygon.
  *
  * @param polygon the list of vertices that make up the polygon
@@ -84,6 +152,33 @@ void polygon_translate(polygon_t *polygon, vector_t translation);
  */
 void polygon_rotate(polygon_t *polygon, double angle, vector_t point);
 
+/**
+ * Returns the bottom-left corner of the polygon's axis-aligned bounding box.
+ * The box is cached and kept up to date as the polygon moves,
+ * so this doesn't scan the vertices.
+ *
+ * @param polygon a polygon_t struct
+ * @return the minimum x and y coordinates of the polygon's vertices
+ */
+vector_t polygon_get_bounds_min(polygon_t *polygon);
+
+/**
+ * Returns the top-right corner of the polygon's axis-aligned bounding box.
+ *
+ * @param polygon a polygon_t struct
+ * @return the maximum x and y coordinates of the polygon's vertices
+ */
+vector_t polygon_get_bounds_max(polygon_t *polygon);
+
+/**
+ * Returns the radius of the smallest circle around the polygon's centroid
+ * that contains all of its vertices. Cached like the bounding box.
+ *
+ * @param polygon a polygon_t struct
+ * @return the distance from the centroid to the farthest vertex
+ */
+double polygon_get_radius(polygon_t *polygon);
+
 /**
  * Return the polygon's color.
  *
@@ -101,7 +196,7 @@ rgb_color_t *polygon_get_color(polygon_t *polygon);
 void polygon_set_color(polygon_t *polygon, rgb_color_t *color);
 
 /**
- * Changes the centroid of the polygon.
+ * Changes the centroid of the polygon, moving the polygon with it.
  *
  * @param polygon a polygon_t struct
  * @param centroid a vector representing the new centroid
@@ -0,0 +1,142 @@
+#ifndef __RENDER_BACKEND_H__
+#define __RENDER_BACKEND_H__
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_ttf.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * A region of a texture stretched over a box in window pixels,
+ * rotated clockwise about the box's center by an angle in radians.
+ */
+typedef struct sprite_quad {
+  SDL_Rect src;
+  SDL_Rect dst;
+  double angle;
+} sprite_quad_t;
+
+/**
+ * The operations sdl_wrapper draws a frame with, in window pixel coordinates.
+ * sdl_wrapper calls whichever backend was passed to sdl_set_render_backend(),
+ * so the same frame can be drawn to a window or nowhere at all.
+ */
+typedef struct render_backend {
+  /**
+   * Sets up whatever the backend draws to. Called once by sdl_init().
+   */
+  void (*init)(const char *title, int width, int height);
+  /**
+   * Gets the current size of the output in pixels.
+   */
+  void (*get_output_size)(int *width, int *height);
+  /**
+   * Fills the whole output with a color.
+   */
+  void (*clear)(SDL_Color color);
+  /**
+   * Fills num_indices / 3 triangles in a single call. Each triangle is the
+   * vertices at 3 consecutive indices, and is filled with their colors.
+   */
+  void (*draw_triangles)(const SDL_Vertex *vertices, size_t num_vertices,
+                         const int *indices, size_t num_indices);
+  /**
+   * Draws the outline of a rectangle.
+   */
+  void (*draw_rect)(SDL_Rect rect, SDL_Color color);
+  /**
+   * Shows everything drawn since the last clear().
+   */
+  void (*present)(void);
+  /**
+   * Loads an image file into a texture. May return NULL.
+   */
+  SDL_Texture *(*load_img_texture)(const char *path);
+  /**
+   * Loads an image file into a new surface, owned by the caller, to be
+   * packed into an atlas before uploading. May return NULL.
+   */
+  SDL_Surface *(*load_img_surface)(const char *path);
+  /**
+   * Renders some text into a new texture, owned by the caller.
+   * May return NULL.
+   */
+  SDL_Texture *(*load_text_texture)(TTF_Font *font, const char *msg,
+                                    SDL_Color color);
+  /**
+   * Uploads a surface into a new texture, owned by the caller.
+   * May return NULL.
+   */
+  SDL_Texture *(*load_surface_texture)(SDL_Surface *surface);
+  /**
+   * Frees a texture returned by load_text_texture() or
+   * load_surface_texture(). Accepts NULL.
+   */
+  void (*destroy_texture)(SDL_Texture *texture);
+  /**
+   * Draws a region of a texture, or all of it if src is NULL, stretched over
+   * a rectangle, rotated clockwise about its center by an angle in radians.
+   */
+  void (*render_texture)(SDL_Texture *texture, const SDL_Rect *src,
+                         SDL_Rect box, double angle);
+  /**
+   * Draws n regions of one texture in a single call, src[i] stretched over
+   * dst[i], with the texture's colors multiplied by a color.
+   */
+  void (*render_texture_regions)(SDL_Texture *texture, const SDL_Rect *src,
+                                 const SDL_Rect *dst, size_t n,
+                                 SDL_Color color);
+  /**
+   * Draws n quads cut from one texture in a single call, in order.
+   */
+  void (*render_sprites)(SDL_Texture *texture, const sprite_quad_t *quads,
+                         size_t n);
+} render_backend_t;
+
+/**
+ * Draws to a window through an SDL_Renderer.
+ */
+extern const render_backend_t RENDER_BACKEND_SDL;
+
+/**
+ * Draws nothing and opens no window, but counts every call,
+ * see render_null_get_counts(). Its textures are all NULL.
+ * Used to run or profile whole frames without a display.
+ */
+extern const render_backend_t RENDER_BACKEND_NULL;
+
+/**
+ * The calls made to RENDER_BACKEND_NULL.
+ */
+typedef struct render_counts {
+  size_t frames; // calls to present()
+  size_t clears;
+  size_t triangle_batches; // calls to draw_triangles()
+  size_t triangles;
+  size_t triangle_vertices;
+  size_t rects;
+  size_t textures;
+  size_t region_batches; // calls to render_texture_regions()
+  size_t regions;
+  size_t sprite_batches; // calls to render_sprites()
+  size_t sprites;
+  size_t images_loaded;
+  size_t texts_loaded;
+  size_t surfaces_loaded;
+  size_t textures_destroyed;
+} render_counts_t;
+
+/**
+ * Gets the number of each kind of call made to RENDER_BACKEND_NULL
+ * since the program started or render_null_reset_counts() was last called.
+ *
+ * @return the counts
+ */
+render_counts_t render_null_get_counts(void);
+
+/**
+ * Zeroes the counts returned by render_null_get_counts().
+ */
+void render_null_reset_counts(void);
+
+#endif // #ifndef __RENDER_BACKEND_H__
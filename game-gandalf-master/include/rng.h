@@ -0,0 +1,74 @@
+#ifndef __RNG_H__
+#define __RNG_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * The state of a xoshiro256** pseudorandom number generator.
+ * Unlike rand(), every generator has its own state, so separate systems can
+ * draw from separate streams and stay reproducible no matter how often the
+ * others draw. Copying the struct forks the stream.
+ */
+typedef struct rng {
+  uint64_t s[4];
+} rng_t;
+
+/**
+ * Seeds a generator.
+ * Generators with the same seed and different stream numbers produce
+ * non-overlapping sequences: each stream starts 2^128 numbers after the last.
+ *
+ * @param seed any seed, e.g. from sdl_get_seed()
+ * @param stream which of the seed's streams to start, e.g. one per system.
+ *   Costs a few hundred operations per stream number, so keep these small.
+ * @return the seeded generator
+ */
+rng_t rng_init(uint64_t seed, uint64_t stream);
+
+/**
+ * Draws 64 uniformly random bits.
+ *
+ * @param rng a generator returned from rng_init()
+ * @return the random bits
+ */
+uint64_t rng_next(rng_t *rng);
+
+/**
+ * Draws a uniformly random double in [0, 1), using 53 random bits.
+ *
+ * @param rng a generator returned from rng_init()
+ * @return the random double
+ */
+double rng_double(rng_t *rng);
+
+/**
+ * Draws a uniformly random double in [low, high).
+ *
+ * @param rng a generator returned from rng_init()
+ * @param low the smallest possible value
+ * @param high the bound on the largest value
+ * @return the random double
+ */
+double rng_range(rng_t *rng, double low, double high);
+
+/**
+ * Draws a uniformly random integer in [0, n), without modulo bias.
+ *
+ * @param rng a generator returned from rng_init()
+ * @param n the number of possible values, at least 1
+ * @return the random integer
+ */
+uint32_t rng_below(rng_t *rng, uint32_t n);
+
+/**
+ * Fills an array with uniformly random doubles in [0, 1),
+ * the same values as calling rng_double() n times.
+ *
+ * @param rng a generator returned from rng_init()
+ * @param values the array to fill
+ * @param n the number of values to draw
+ */
+void rng_fill_doubles(rng_t *rng, double *values, size_t n);
+
+#endif // #ifndef __RNG_H__
@@ -3,7 +3,9 @@
 
 // #include "asset.h"
 #include "body.h"
+#include "collision.h"
 #include "list.h"
+#include <stdint.h>
 
 /**
  * A collection of bodies and force creators.
@@ -12,6 +14,40 @@
  */
 typedef struct scene scene_t;
 
+/**
+ * A stable reference to a body in a scene.
+ * Unlike an index, a handle keeps referring to the same body while other
+ * bodies are added and removed. Once its body is freed, the handle becomes
+ * stale and looking it up returns NULL instead of a dangling pointer.
+ */
+typedef struct body_handle {
+  uint32_t index;
+  uint32_t generation;
+} body_handle_t;
+
+/**
+ * A handle that never refers to a body.
+ */
+extern const body_handle_t BODY_HANDLE_NULL;
+
+/**
+ * Counts and timings accumulated over the ticks of a scene, for benchmarks.
+ * Times are in nanoseconds, as measured by timer_now_ns().
+ */
+typedef struct scene_stats {
+  size_t ticks;
+  // broadphase pairs that a collision rule applies to, i.e. narrowphase tests
+  size_t pairs_tested;
+  // collision handlers called
+  size_t collisions;
+  uint64_t broadphase_ns;
+  uint64_t force_creators_ns;
+  uint64_t narrowphase_ns;
+  uint64_t handlers_ns;
+  uint64_t commands_ns;
+  uint64_t integrate_ns;
+} scene_stats_t;
+
 /**
  * A function which adds some forces or impulses to bodies,
  * e.g. from collisions, gravity, or spring forces.
@@ -47,6 +83,8 @@ size_t scene_bodies(scene_t *scene);
 /**
  * Gets the body at a given index in a scene.
  * Asserts that the index is valid.
+ * Indices are dense, but shift when bodies are removed; use a body_handle_t
+ * to keep track of a particular body.
  *
  * @param scene a pointer to a scene returned from scene_init()
  * @param index the index of the body in the scene (starting at 0)
@@ -56,11 +94,61 @@ body_t *scene_get_body(scene_t *scene, size_t index);
 
 /**
  * Adds a body to a scene.
+ * Must not be called during scene_tick(), e.g. from a collision handler;
+ * use scene_queue_add_body() instead.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param body a pointer to the body to add to the scene
+ * @return a handle to the body, valid until the body is removed and freed
+ */
+body_handle_t scene_add_body(scene_t *scene, body_t *body);
+
+/**
+ * Queues a body to be added to a scene by the next scene_tick().
+ * Queued commands are applied in the order they were queued, in one pass
+ * after the collision handlers run and before the bodies are integrated,
+ * so this is safe to call from force creators and collision handlers.
+ * Until then, the body is not in the scene and the handle looks up NULL.
  *
  * @param scene a pointer to a scene returned from scene_init()
  * @param body a pointer to the body to add to the scene
+ * @return a handle to the body, valid once the body has been added
+ */
+body_handle_t scene_queue_add_body(scene_t *scene, body_t *body);
+
+/**
+ * Looks up a body by its handle in constant time.
+ * A body marked with body_remove() can still be looked up until the end of
+ * the scene_tick() that frees it.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param handle a handle returned from scene_add_body()
+ * @return the body, or NULL if the handle is stale or BODY_HANDLE_NULL
+ */
+body_t *scene_get_body_by_handle(scene_t *scene, body_handle_t handle);
+
+/**
+ * Gets the handle of the body at a given index in a scene,
+ * e.g. to keep referring to it after the indices shift.
+ * Asserts that the index is valid.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param index the index of the body in the scene (starting at 0)
+ * @return the body's handle
  */
-void scene_add_body(scene_t *scene, body_t *body);
+body_handle_t scene_get_handle(scene_t *scene, size_t index);
+
+/**
+ * Marks the body a handle refers to for removal, like body_remove().
+ * Does nothing if the handle is stale.
+ * Marking takes constant time, but the body is only freed on the next
+ * scene_tick(), which compacts the remaining bodies in order, so a tick
+ * that frees bodies takes time linear in the number of bodies.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param handle a handle returned from scene_add_body()
+ */
+void scene_remove_body_by_handle(scene_t *scene, body_handle_t handle);
 
 /**
  * @deprecated Use body_remove() instead
@@ -96,16 +184,154 @@ void scene_add_force_creator(scene_t *scene, force_creator_t forcer, void *aux);
 void scene_add_bodies_force_creator(scene_t *scene, force_creator_t forcer,
                                     void *aux, list_t *bodies);
 
+/**
+ * Adds a force creator like scene_add_bodies_force_creator(), for force
+ * creators that do more than read bodies and call body_add_force() or
+ * body_add_impulse(), e.g. ones that call collision handlers.
+ * When the scene ticks on several threads (see scene_set_num_threads()),
+ * these still run on the thread calling scene_tick(), in their usual order.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param forcer a force creator function
+ * @param aux an auxiliary value to pass to forcer when it is called
+ * @param bodies the list of bodies affected by the force creator
+ */
+void scene_add_serial_force_creator(scene_t *scene, force_creator_t forcer,
+                                    void *aux, list_t *bodies);
+
+/**
+ * Queues a force creator to be added like scene_add_bodies_force_creator(),
+ * in the same pass as scene_queue_add_body().
+ * The bodies may be ones queued with scene_queue_add_body() earlier.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param forcer a force creator function
+ * @param aux an auxiliary value to pass to forcer when it is called
+ * @param bodies the list of bodies affected by the force creator
+ */
+void scene_queue_bodies_force_creator(scene_t *scene, force_creator_t forcer,
+                                      void *aux, list_t *bodies);
+
+/**
+ * Registers a collision handler for every pair of bodies in two categories.
+ * Each tick, the scene runs find_collision() on the pairs of nearby bodies
+ * that some rule applies to, and calls the handler when they start colliding.
+ * Like create_collision(), the handler is only called once while the bodies
+ * stay in contact.
+ * The first body passed to the handler is always the one in category1.
+ *
+ * Unlike create_collision(), this costs nothing per body, so bodies only need
+ * to be given a category with body_set_category() when they are created.
+ * Registering a rule for a pair of categories replaces any earlier rule
+ * for that pair.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param category1 a bitmask of the categories of the first body
+ * @param category2 a bitmask of the categories of the second body
+ * @param handler the function to call when two such bodies collide
+ * @param aux an auxiliary value to pass to the handler
+ * @param force_const a constant to pass to the handler
+ */
+void scene_add_collision_rule(scene_t *scene, uint32_t category1,
+                              uint32_t category2, collision_handler_t handler,
+                              void *aux, double force_const);
+
+/**
+ * Returns whether two bodies are close enough to possibly be colliding.
+ * This is answered by the scene's broadphase, which is rebuilt from the body
+ * positions at the start of every scene_tick(), so it is only meaningful
+ * for force creators running inside scene_tick().
+ * Bodies whose bounding boxes do not overlap can skip the exact
+ * find_collision() test.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param body1 the first body
+ * @param body2 the second body
+ * @return false if the bodies are certainly not colliding
+ */
+bool scene_may_collide(scene_t *scene, body_t *body1, body_t *body2);
+
+/**
+ * Sets how many threads scene_tick() runs force creators, the collision
+ * narrowphase and integration on.
+ * Scenes start with 1, which runs everything on the calling thread.
+ * Collision handlers always run on the calling thread.
+ * With more, force creators apply their forces to per-thread logs that are
+ * replayed in order, so the results are bit-identical for any thread count.
+ * Only native builds with USE_PTHREADS start extra threads; other builds
+ * still run on 1.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param num_threads the number of threads, including the calling thread
+ */
+void scene_set_num_threads(scene_t *scene, size_t num_threads);
+
 /**
  * Executes a tick of a given scene over a small time interval.
  * This requires executing all the force creators
  * and then ticking each body (see body_tick()).
- * If any bodies are marked for removal, they should be removed from the scene
- * and freed, along with any force creators acting on them.
+ * Between the two, queued bodies and force creators are added, and bodies
+ * marked for removal are removed from the scene and freed,
+ * along with any force creators acting on them.
  *
  * @param scene a pointer to a scene returned from scene_init()
  * @param dt the time elapsed since the last tick, in seconds
  */
 list_t *scene_tick(scene_t *scene, list_t *assets, double dt);
 
+/**
+ * Advances a scene by some real time in ticks of a fixed length, so the
+ * simulation behaves the same at any frame rate.
+ * Time left over after the last whole tick is carried into the next call;
+ * see scene_get_interpolation_alpha() for drawing bodies in between ticks.
+ * Runs at most max_substeps ticks per call. Any further whole ticks are
+ * dropped, so a slow frame slows the simulation down instead of making the
+ * next frame take even longer to catch up.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param assets the game's assets, as for scene_tick()
+ * @param dt the real time elapsed since the last call, in seconds
+ * @param dt_fixed the length of each tick, in seconds
+ * @param max_substeps the most ticks to run in this call
+ * @return the positions of the asteroids removed during all of the ticks
+ */
+list_t *scene_step_fixed(scene_t *scene, list_t *assets, double dt,
+                         double dt_fixed, size_t max_substeps);
+
+/**
+ * Gets how far the time carried over by scene_step_fixed() is through the
+ * next tick, to pass to body_get_interpolated_centroid() when rendering.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @return a fraction in [0, 1), or 1 if scene_step_fixed() hasn't run
+ */
+double scene_get_interpolation_alpha(scene_t *scene);
+
+/**
+ * Hashes the number of bodies in a scene and the position, velocity, angle
+ * and angular velocity of each one, bit for bit and in order.
+ * Two runs of a deterministic simulation have equal digests at equal ticks,
+ * so comparing digests finds where two runs diverge.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @return a 64-bit FNV-1a hash of the bodies' state
+ */
+uint64_t scene_digest(scene_t *scene);
+
+/**
+ * Gets the counts and per-phase timings of every scene_tick() of a scene
+ * since it was created or scene_reset_stats() was last called.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @return the accumulated stats
+ */
+scene_stats_t scene_get_stats(scene_t *scene);
+
+/**
+ * Zeroes the stats returned by scene_get_stats(), e.g. after warming up.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ */
+void scene_reset_stats(scene_t *scene);
+
 #endif // #ifndef __SCENE_H__
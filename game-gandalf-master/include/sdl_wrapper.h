@@ -2,9 +2,12 @@
 #define __SDL_WRAPPER_H__
 
 #include "color.h"
+#include "frame_timer.h"
 #include "list.h"
 #include "polygon.h"
+#include "render_backend.h"
 #include "scene.h"
+#include "sprite_atlas.h"
 #include "state.h"
 #include "vector.h"
 
@@ -65,6 +68,15 @@ typedef void (*mouse_handler_t)(void *state, double x, double y);
  */
 void sdl_init(vector_t min, vector_t max);
 
+/**
+ * Chooses what the drawing functions below draw with, e.g.
+ * RENDER_BACKEND_NULL to run frames without a window.
+ * Must be called before sdl_init(); the default is RENDER_BACKEND_SDL.
+ *
+ * @param render_backend the backend to draw with
+ */
+void sdl_set_render_backend(const render_backend_t *render_backend);
+
 /**
  * Processes all SDL events and returns whether the window has been closed.
  * This function must be called in order to handle inputs.
@@ -73,6 +85,14 @@ void sdl_init(vector_t min, vector_t max);
  */
 bool sdl_is_done(void *state);
 
+/**
+ * Finishes recording or replaying, printing a replay's summary, and frees
+ * the frame time history. sdl_is_done() calls this before returning true;
+ * any other way out of the game must call it before exiting.
+ * Does nothing if it has already been called.
+ */
+void sdl_finish(void);
+
 /**
  * Clears the screen. Should be called before drawing polygons in each frame.
  */
@@ -80,12 +100,24 @@ void sdl_clear(void);
 
 /**
  * Draws a polygon from the given list of vertices and a color.
+ * Polygons are queued and drawn together in one batch of triangles
+ * when anything else is drawn or the frame is shown.
+ * The polygon is drawn where it is now, not interpolated; see sdl_draw_body().
  *
  * @param poly a struct representing the polygon
  * @param color the color used to fill in the polygon
  */
 void sdl_draw_polygon(polygon_t *poly, rgb_color_t *color);
 
+/**
+ * Draws a body's polygon in its color like sdl_draw_polygon(), but at the
+ * body's interpolated position (see sdl_set_interpolation()), where its
+ * sprite is drawn too.
+ *
+ * @param body the body to draw
+ */
+void sdl_draw_body(body_t *body);
+
 /**
  * Displays the rendered frame on the SDL window.
  * Must be called after drawing the polygons in order to show them.
@@ -94,7 +126,7 @@ void sdl_show(void);
 
 /**
  * Draws all bodies in a scene.
- * This internally calls sdl_clear(), sdl_draw_polygon(), and sdl_show(),
+ * This internally calls sdl_clear(), sdl_draw_body(), and sdl_show(),
  * so those functions should not be called directly.
  *
  * @param scene the scene to draw
@@ -141,13 +173,84 @@ void sdl_on_click(mouse_handler_t handler);
 /**
  * Gets the amount of time that has passed since the last time
  * this function was called, in seconds.
+ * Measures wall time with timer_now_ns(), and records each frame in the
+ * history returned by sdl_get_frame_stats().
  *
  * @return the number of seconds that have elapsed
  */
 double time_since_last_tick(void);
 
 /**
- * Returns the SDL_Rect that encompasses the entire body in minimal space
+ * Gets the history of the latest frame times measured by
+ * time_since_last_tick(), e.g. to display frame_stats_summarize().
+ * The history is freed once sdl_is_done() returns true.
+ *
+ * @return the frame time history
+ */
+frame_stats_t *sdl_get_frame_stats(void);
+
+/**
+ * Gets the seed to seed the game's RNG with: the recorded one while replaying,
+ * otherwise one chosen from the time on the first call.
+ *
+ * @return the seed
+ */
+uint32_t sdl_get_seed(void);
+
+/**
+ * Starts recording the match to a file: the seed from sdl_get_seed(), then,
+ * for every frame, the time returned by time_since_last_tick() and the input
+ * handled by sdl_is_done(), with a keyframe from sdl_track_scene() every
+ * 120 frames. See input_log_t.
+ * Must be called before the game starts, and before sdl_get_seed().
+ *
+ * @param path the file to record to
+ * @return false if the file couldn't be opened
+ */
+bool sdl_record_input(const char *path);
+
+/**
+ * Replays a recording made with sdl_record_input() instead of reading the
+ * keyboard, mouse and clock. Frames take exactly their recorded times but
+ * run back to back, so pairing this with RENDER_BACKEND_NULL replays a match
+ * as fast as the game can simulate it.
+ * Each keyframe is compared with the scene passed to sdl_track_scene().
+ * Once the recording runs out, sdl_is_done() prints the replay's speed,
+ * keyframe mismatches and the scene's stats as JSON and returns true.
+ * Must be called before the game starts.
+ *
+ * @param path the file to replay
+ * @return false if the file couldn't be read
+ */
+bool sdl_replay_input(const char *path);
+
+/**
+ * Tells the recorder which scene the game is simulating, after the frame's
+ * ticks. Keyframes record or check a digest of it, see scene_digest().
+ *
+ * @param scene the scene that was ticked this frame
+ */
+void sdl_track_scene(scene_t *scene);
+
+/**
+ * Sets how far through their latest tick bodies are drawn,
+ * see body_get_interpolated_centroid(). Initially 1 (the current state).
+ *
+ * @param alpha the interpolation fraction, e.g. from
+ *   scene_get_interpolation_alpha()
+ */
+void sdl_set_interpolation(double alpha);
+
+/**
+ * Gets the interpolation fraction set with sdl_set_interpolation().
+ *
+ * @return the fraction of their latest tick bodies are drawn at
+ */
+double sdl_get_interpolation(void);
+
+/**
+ * Returns the SDL_Rect that encompasses the entire body in minimal space,
+ * at the body's interpolated position (see sdl_set_interpolation())
  *
  * @param body body that is to be encompassed by the constructed SDL_Rect
  *
@@ -177,6 +280,32 @@ SDL_Texture *sdl_load_text_texture(TTF_Font *font, const char *msg,
  */
 SDL_Texture *sdl_load_img_texture(const char *IMG_PATH);
 
+/**
+ * Returns the image as a surface, owned by the caller
+ *
+ * @param IMG_PATH the file path of the image
+ *
+ * @return surface of the image loaded
+ */
+SDL_Surface *sdl_load_img_surface(const char *IMG_PATH);
+
+/**
+ * Uploads a surface into a new texture, owned by the caller
+ *
+ * @param surface the surface to upload, which the caller still owns
+ *
+ * @return the new texture
+ */
+SDL_Texture *sdl_load_surface_texture(SDL_Surface *surface);
+
+/**
+ * Frees a texture returned by sdl_load_text_texture() or
+ * sdl_load_surface_texture()
+ *
+ * @param texture the texture to free, or NULL
+ */
+void sdl_destroy_texture(SDL_Texture *texture);
+
 /**
  * Renders the texture in the SDL_Rect box
  *
@@ -205,4 +334,33 @@ void sdl_render_rotate_texture(SDL_Texture *texture, SDL_Rect bounding_box,
 void sdl_render_rotate_texture(SDL_Texture *texture, SDL_Rect bounding_box,
                                double angle);
 
+/**
+ * Renders a sprite in the SDL_Rect box, rotated.
+ * Sprites are queued and drawn in batches, one per texture, when anything
+ * else is drawn or the frame is shown. The sprites in a run of reorderable
+ * sprites are grouped by texture, so may be drawn out of order; any other
+ * sprite is drawn in the order it was rendered.
+ *
+ * @param sprite the sprite, e.g. from the asset cache
+ * @param SDL_Rect with the location and dimensions for the sprite
+ * @param angle in radians to rotate SDL_Rect about its center clockwise
+ * @param reorderable whether the sprite may be drawn before or after the
+ *   reorderable sprites rendered next to it
+ */
+void sdl_render_sprite(sprite_t sprite, SDL_Rect bounding_box, double angle,
+                       bool reorderable);
+
+/**
+ * Renders n regions of a texture at once, e.g. the glyphs of a string
+ *
+ * @param texture the texture holding every region
+ * @param src the regions of the texture to draw
+ * @param dst the boxes to stretch each region over
+ * @param n the number of regions
+ * @param color the color to multiply the texture by, each channel in [0, 255]
+ */
+void sdl_render_texture_regions(SDL_Texture *texture, const SDL_Rect *src,
+                                const SDL_Rect *dst, size_t n,
+                                rgb_color_t color);
+
 #endif // #ifndef __SDL_WRAPPER_H__
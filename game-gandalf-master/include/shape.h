@@ -0,0 +1,128 @@
+#ifndef __SHAPE_H__
+#define __SHAPE_H__
+
+#include "list.h"
+#include "vector.h"
+#include <stddef.h>
+
+/**
+ * An immutable convex polygon in local space, shared by every body that has
+ * the same outline. The vertices are stored relative to the shape's centroid,
+ * together with the area, the bounding radius and the unit normals of the
+ * edges used as separating axes by find_collision().
+ */
+typedef struct shape shape_t;
+
+/**
+ * Initializes the empty, list-based global shape registry. The caller must
+ * then destroy the registry with `shape_registry_destroy` when done.
+ */
+void shape_registry_init();
+
+/**
+ * Frees the global shape registry and every shape in it.
+ * Bodies using registered shapes must be freed first.
+ */
+void shape_registry_destroy();
+
+/**
+ * Gets the shared shape of a regular polygon centered at the origin,
+ * creating and registering it the first time it is asked for.
+ * The first vertex is at angle 0.
+ *
+ * @param num_points the number of vertices
+ * @param radius the distance from the center to each vertex
+ * @return the registered shape, owned by the registry
+ */
+shape_t *shape_get_regular_polygon(size_t num_points, double radius);
+
+/**
+ * Gets the shared shape of an axis-aligned rectangle with its bottom-left
+ * corner at the origin, creating and registering it the first time it is
+ * asked for.
+ *
+ * @param width the width of the rectangle
+ * @param height the height of the rectangle
+ * @return the registered shape, owned by the registry
+ */
+shape_t *shape_get_rectangle(double width, double height);
+
+/**
+ * Creates an unregistered shape from a list of vertices.
+ * Asserts that the required memory is allocated.
+ *
+ * @param points the vertices of a convex polygon, in counterclockwise order.
+ * The shape copies them, so the list still belongs to the caller.
+ * @return a pointer to the new shape, freed with shape_free()
+ */
+shape_t *shape_init(list_t *points);
+
+/**
+ * Frees an unregistered shape returned from shape_init().
+ *
+ * @param shape a pointer to a shape returned from shape_init()
+ */
+void shape_free(shape_t *shape);
+
+/**
+ * Returns the number of vertices (and edges) of a shape.
+ *
+ * @param shape a pointer to a shape
+ * @return the number of vertices
+ */
+size_t shape_num_vertices(shape_t *shape);
+
+/**
+ * Returns the vertices of a shape relative to its centroid.
+ *
+ * @param shape a pointer to a shape
+ * @return a contiguous array of shape_num_vertices() vectors
+ */
+const vector_t *shape_get_vertices(shape_t *shape);
+
+/**
+ * Returns the unit normals of a shape's edges.
+ * Normal i is perpendicular to the edge from vertex i to vertex i + 1.
+ *
+ * @param shape a pointer to a shape
+ * @return a contiguous array of shape_num_vertices() unit vectors
+ */
+const vector_t *shape_get_normals(shape_t *shape);
+
+/**
+ * Returns the triangles that cover a shape, e.g. for drawing it.
+ * There are shape_num_vertices() - 2 triangles, and the indices of the
+ * vertices of triangle i are at 3 * i, 3 * i + 1 and 3 * i + 2.
+ *
+ * @param shape a pointer to a shape
+ * @return a contiguous array of 3 * (shape_num_vertices() - 2) indices
+ *   into shape_get_vertices()
+ */
+const int *shape_get_triangles(shape_t *shape);
+
+/**
+ * Returns the area of a shape.
+ *
+ * @param shape a pointer to a shape
+ * @return the area
+ */
+double shape_get_area(shape_t *shape);
+
+/**
+ * Returns the centroid of the vertices the shape was created from.
+ * Placing a body using the shape at this point reproduces those vertices.
+ *
+ * @param shape a pointer to a shape
+ * @return the offset of the centroid from the origin of the input vertices
+ */
+vector_t shape_get_centroid_offset(shape_t *shape);
+
+/**
+ * Returns the distance from a shape's centroid to its farthest vertex.
+ *
+ * @param shape a pointer to a shape
+ * @return the bounding radius
+ */
+double shape_get_radius(shape_t *shape);
+
+#endif // #ifndef __SHAPE_H__
@@ -0,0 +1,92 @@
+#ifndef __SPATIAL_HASH_H__
+#define __SPATIAL_HASH_H__
+
+#include "body.h"
+#include "pair_set.h"
+#include "vector.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * A uniform grid broadphase.
+ * Bodies are bucketed into square cells by their axis-aligned bounding boxes,
+ * and only bodies whose boxes overlap are reported as candidate pairs.
+ * The grid is rebuilt from scratch every tick.
+ */
+typedef struct spatial_hash spatial_hash_t;
+
+/**
+ * Allocates memory for an empty spatial hash.
+ * Asserts that the cell size is positive and that the required memory is
+ * allocated.
+ *
+ * @param cell_size the side length of each grid cell, in scene units.
+ *   Should be roughly the size of a typical body.
+ * @return a pointer to the newly allocated spatial hash
+ */
+spatial_hash_t *spatial_hash_init(double cell_size);
+
+/**
+ * Releases the memory allocated for a spatial hash.
+ * Does not free the bodies inserted into it.
+ *
+ * @param hash a pointer to a spatial hash returned from spatial_hash_init()
+ */
+void spatial_hash_free(spatial_hash_t *hash);
+
+/**
+ * Removes all bodies and candidate pairs from the spatial hash,
+ * keeping its memory around for the next tick.
+ *
+ * @param hash a pointer to a spatial hash returned from spatial_hash_init()
+ */
+void spatial_hash_clear(spatial_hash_t *hash);
+
+/**
+ * Inserts a body into every cell covered by its bounding box.
+ *
+ * @param hash a pointer to a spatial hash returned from spatial_hash_init()
+ * @param body the body to insert
+ */
+void spatial_hash_insert(spatial_hash_t *hash, body_t *body);
+
+/**
+ * Computes the candidate pairs of the inserted bodies.
+ * Each pair of bodies with overlapping bounding boxes is reported exactly once,
+ * in an order that only depends on the order the bodies were inserted in.
+ * Must be called after all the bodies for this tick are inserted.
+ *
+ * @param hash a pointer to a spatial hash returned from spatial_hash_init()
+ */
+void spatial_hash_build_pairs(spatial_hash_t *hash);
+
+/**
+ * Gets the number of candidate pairs found by spatial_hash_build_pairs().
+ *
+ * @param hash a pointer to a spatial hash returned from spatial_hash_init()
+ * @return the number of candidate pairs
+ */
+size_t spatial_hash_num_pairs(spatial_hash_t *hash);
+
+/**
+ * Gets the candidate pair at a given index.
+ * Asserts that the index is valid.
+ *
+ * @param hash a pointer to a spatial hash returned from spatial_hash_init()
+ * @param index the index of the pair (starting at 0)
+ * @return the pair of bodies
+ */
+body_pair_t spatial_hash_get_pair(spatial_hash_t *hash, size_t index);
+
+/**
+ * Returns whether two bodies were reported as a candidate pair.
+ * The order of the bodies does not matter.
+ *
+ * @param hash a pointer to a spatial hash returned from spatial_hash_init()
+ * @param body1 the first body
+ * @param body2 the second body
+ * @return whether the bodies' bounding boxes overlap
+ */
+bool spatial_hash_has_pair(spatial_hash_t *hash, body_t *body1, body_t *body2);
+
+#endif // #ifndef __SPATIAL_HASH_H__
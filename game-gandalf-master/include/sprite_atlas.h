@@ -0,0 +1,66 @@
+#ifndef __SPRITE_ATLAS_H__
+#define __SPRITE_ATLAS_H__
+
+#include <SDL2/SDL.h>
+#include <stddef.h>
+
+/**
+ * An image to draw: a region of a texture, which is usually shared with
+ * other sprites.
+ */
+typedef struct sprite {
+  SDL_Texture *texture;
+  SDL_Rect region;
+} sprite_t;
+
+/**
+ * A set of images packed into as few textures ("pages") as possible,
+ * so that drawing them binds few textures and can be batched.
+ */
+typedef struct sprite_atlas sprite_atlas_t;
+
+/**
+ * Loads images and packs them onto pages of at most 4096x4096 pixels,
+ * tallest first onto shelves. An image too big for a page gets a page of
+ * its own. Images that can't be loaded become sprites with a NULL texture.
+ *
+ * @param paths the filepaths of the images
+ * @param num_paths the number of images
+ * @return the new atlas, whose sprites are in the same order as `paths`
+ */
+sprite_atlas_t *sprite_atlas_build(const char **paths, size_t num_paths);
+
+/**
+ * Gets the number of sprites in an atlas.
+ *
+ * @param atlas an atlas returned from sprite_atlas_build()
+ * @return the number of images it was built from
+ */
+size_t sprite_atlas_num_sprites(sprite_atlas_t *atlas);
+
+/**
+ * Gets the number of textures an atlas packed its images onto.
+ *
+ * @param atlas an atlas returned from sprite_atlas_build()
+ * @return the number of pages
+ */
+size_t sprite_atlas_num_pages(sprite_atlas_t *atlas);
+
+/**
+ * Gets one of the packed images.
+ * Asserts that the index is valid.
+ *
+ * @param atlas an atlas returned from sprite_atlas_build()
+ * @param index the index of the image's path in `paths`
+ * @return the image's texture and where it is in the texture
+ */
+sprite_t sprite_atlas_get(sprite_atlas_t *atlas, size_t index);
+
+/**
+ * Frees an atlas and its textures, invalidating its sprites.
+ *
+ * @param atlas an atlas returned from sprite_atlas_build()
+ */
+void sprite_atlas_free(sprite_atlas_t *atlas);
+
+#endif // #ifndef __SPRITE_ATLAS_H__
@@ -0,0 +1,132 @@
+#ifndef __THREAD_POOL_H__
+#define __THREAD_POOL_H__
+
+#include <stddef.h>
+
+/**
+ * A work-stealing task scheduler.
+ * Every thread in the pool has its own deque of ready tasks: it runs the
+ * tasks it submitted most recently first, and when it runs out, steals the
+ * oldest tasks from the other threads.
+ * Threads are only used in native builds with USE_PTHREADS defined
+ * (see 'make THREADS=true'); otherwise the pool has a single deque and every
+ * task runs on the thread that waits for it.
+ */
+typedef struct thread_pool thread_pool_t;
+
+/**
+ * A unit of work submitted to a thread pool.
+ */
+typedef struct task task_t;
+
+/**
+ * The work a task or job does.
+ *
+ * @param aux the auxiliary value the task was created with
+ * @param index the index the task was created with, e.g. its index in a batch
+ */
+typedef void (*job_func_t)(void *aux, size_t index);
+
+/**
+ * The work done on one chunk of a thread_pool_parallel_for().
+ *
+ * @param aux the auxiliary value passed to thread_pool_parallel_for()
+ * @param start the first index in the chunk
+ * @param end one past the last index in the chunk
+ */
+typedef void (*range_func_t)(void *aux, size_t start, size_t end);
+
+/**
+ * Allocates a thread pool and starts its worker threads.
+ * Asserts that the required memory is allocated and the threads started.
+ *
+ * @param num_threads the number of threads to run tasks on,
+ *   including the thread that waits for them. Must be at least 1.
+ * @return the new thread pool
+ */
+thread_pool_t *thread_pool_init(size_t num_threads);
+
+/**
+ * Stops the worker threads of a thread pool and releases its memory.
+ * Every submitted task must have been waited for.
+ *
+ * @param pool a pointer to a thread pool returned from thread_pool_init()
+ */
+void thread_pool_free(thread_pool_t *pool);
+
+/**
+ * Gets the number of threads that run tasks in a thread pool.
+ * Always 1 without USE_PTHREADS.
+ *
+ * @param pool a pointer to a thread pool returned from thread_pool_init()
+ * @return the number of threads, including the waiting thread
+ */
+size_t thread_pool_num_threads(thread_pool_t *pool);
+
+/**
+ * Allocates a task that will call job(aux, index) once submitted
+ * and all of its dependencies have finished.
+ *
+ * @param job the function the task calls
+ * @param aux an auxiliary value to pass to the function
+ * @param index an index to pass to the function
+ * @return the new task, which thread_pool_wait() frees
+ */
+task_t *thread_pool_task_init(job_func_t job, void *aux, size_t index);
+
+/**
+ * Makes a task wait for another one to finish before it starts.
+ * Neither task may have been submitted yet.
+ *
+ * @param task a task returned from thread_pool_task_init()
+ * @param dependency a task that must finish first
+ */
+void thread_pool_task_depends_on(task_t *task, task_t *dependency);
+
+/**
+ * Hands a task to a thread pool, to run as soon as its dependencies finish.
+ *
+ * @param pool a pointer to a thread pool returned from thread_pool_init()
+ * @param task a task returned from thread_pool_task_init()
+ */
+void thread_pool_submit(thread_pool_t *pool, task_t *task);
+
+/**
+ * Runs other tasks until a submitted task has finished, then frees it.
+ * Every submitted task must be waited for exactly once.
+ *
+ * @param pool the thread pool the task was submitted to
+ * @param task a task passed to thread_pool_submit()
+ */
+void thread_pool_wait(thread_pool_t *pool, task_t *task);
+
+/**
+ * Runs job(aux, i) for every i in [0, num_jobs), one task each,
+ * and returns once all of them have finished.
+ * Jobs may run in any order and concurrently, so they must not write to
+ * anything another job in the batch reads or writes.
+ *
+ * @param pool a pointer to a thread pool returned from thread_pool_init()
+ * @param job the function to call for each job
+ * @param aux an auxiliary value to pass to every job
+ * @param num_jobs the number of jobs in the batch
+ */
+void thread_pool_run(thread_pool_t *pool, job_func_t job, void *aux,
+                     size_t num_jobs);
+
+/**
+ * Splits [start, end) into chunks of at least `grain` indices, runs func on
+ * every chunk like thread_pool_run(), and returns once all of them finish.
+ *
+ * @param pool a pointer to a thread pool returned from thread_pool_init()
+ * @param func the function to call on each chunk
+ * @param aux an auxiliary value to pass to every call
+ * @param start the first index of the range
+ * @param end one past the last index of the range
+ * @param grain the smallest number of indices worth a task of its own
+ */
+void thread_pool_parallel_for(thread_pool_t *pool, range_func_t func,
+                              void *aux, size_t start, size_t end,
+                              size_t grain);
+
+#endif // #ifndef __THREAD_POOL_H__
@@ -1,10 +1,12 @@
 #include <SDL2/SDL_image.h>
 #include <SDL2/SDL_ttf.h>
 #include <assert.h>
+#include <string.h>
 
 #include "asset.h"
 #include "asset_cache.h"
 #include "color.h"
+#include "glyph_atlas.h"
 #include "sdl_wrapper.h"
 
 typedef struct asset {
@@ -18,11 +20,16 @@ typedef struct text_asset {
   const char *system;
   const char *text;
   rgb_color_t color;
+  // `texture` shows `rendered_text` in `rendered_color`, rasterized by the
+  // last render; `rendered_text` is NULL until the first render
+  SDL_Texture *texture;
+  char *rendered_text;
+  rgb_color_t rendered_color;
 } text_asset_t;
 
 typedef struct image_asset {
   asset_t base;
-  SDL_Texture *texture;
+  sprite_t sprite;
   body_t *body;
 } image_asset_t;
 
@@ -88,18 +95,18 @@ static asset_t *asset_init(asset_type_t ty, SDL_Rect bounding_box) {
 asset_type_t asset_get_type(asset_t *asset) { return asset->type; }
 
 asset_t *asset_make_image(const char *filepath, SDL_Rect bounding_box) {
-  SDL_Texture *img = asset_cache_obj_get_or_create(ASSET_IMAGE, filepath);
+  sprite_t *img = asset_cache_obj_get_or_create(ASSET_IMAGE, filepath);
   asset_t *asset = asset_init(ASSET_IMAGE, bounding_box);
-  ((image_asset_t *)asset)->texture = img;
+  ((image_asset_t *)asset)->sprite = *img;
   ((image_asset_t *)asset)->body = NULL;
   return asset;
 }
 
 asset_t *asset_make_image_with_body(const char *filepath, body_t *body) {
-  SDL_Texture *img = asset_cache_obj_get_or_create(ASSET_IMAGE, filepath);
+  sprite_t *img = asset_cache_obj_get_or_create(ASSET_IMAGE, filepath);
   SDL_Rect rect = sdl_get_bounding_box(body);
   asset_t *asset = asset_init(ASSET_IMAGE, rect);
-  ((image_asset_t *)asset)->texture = img;
+  ((image_asset_t *)asset)->sprite = *img;
   ((image_asset_t *)asset)->body = body;
   return asset;
 }
@@ -117,6 +124,8 @@ asset_t *asset_make_text(const char *filepath, SDL_Rect bounding_box,
   ((text_asset_t *)asset)->system = system;
   ((text_asset_t *)asset)->text = text;
   ((text_asset_t *)asset)->color = color;
+  ((text_asset_t *)asset)->texture = NULL;
+  ((text_asset_t *)asset)->rendered_text = NULL;
   return asset;
 }
 
@@ -154,7 +163,8 @@ asset_t *asset_make_button(SDL_Rect bounding_box, asset_t *image_asset,
                            asset_t *text_asset, button_handler_t handler) {
   asset_t *asset = asset_init(ASSET_BUTTON, bounding_box);
 
-  if (image_asset != NULL && ((image_asset_t *)image_asset)->texture != NULL) {
+  if (image_asset != NULL &&
+      ((image_asset_t *)image_asset)->sprite.texture != NULL) {
     assert(image_asset->type == ASSET_IMAGE);
     ((button_asset_t *)asset)->image_asset = (image_asset_t *)image_asset;
   } else {
@@ -199,28 +209,60 @@ void asset_on_button_click(asset_t *button, state_t *state, double x,
   ((button_asset_t *)button)->is_rendered = false;
 }
 
+/**
+ * Rasterizes a text asset's text into its texture, unless the texture already
+ * shows the same text in the same color. The text is compared by content,
+ * since callers may rewrite the string in place.
+ */
+static void text_asset_update_texture(text_asset_t *text_asset) {
+  if (text_asset->rendered_text != NULL &&
+      strcmp(text_asset->rendered_text, text_asset->text) == 0 &&
+      color_compare(text_asset->rendered_color, text_asset->color)) {
+    return;
+  }
+  if (text_asset->rendered_text != NULL) {
+    sdl_destroy_texture(text_asset->texture);
+    free(text_asset->rendered_text);
+  }
+  text_asset->texture = sdl_load_text_texture(
+      text_asset->font, text_asset->text, text_asset->color);
+  size_t length = strlen(text_asset->text) + 1;
+  text_asset->rendered_text = malloc(length);
+  assert(text_asset->rendered_text);
+  memcpy(text_asset->rendered_text, text_asset->text, length);
+  text_asset->rendered_color = text_asset->color;
+}
+
 void asset_render(asset_t *asset) {
   switch (asset->type) {
   case ASSET_IMAGE: {
-    SDL_Texture *texture = ((image_asset_t *)asset)->texture;
+    sprite_t sprite = ((image_asset_t *)asset)->sprite;
     body_t *body = ((image_asset_t *)asset)->body;
     if (body && !body_is_removed(body)) {
       SDL_Rect box = sdl_get_bounding_box(body);
-      double body_rot = body_get_direction_angle(body);
-      sdl_render_rotate_texture(texture, box, body_rot);
+      double body_rot =
+          body_get_interpolated_direction_angle(body, sdl_get_interpolation());
+      // bodies rarely overlap, so they are drawn grouped by texture
+      sdl_render_sprite(sprite, box, body_rot, true);
     } else {
+      // backgrounds and HUD icons stay under or over the bodies
       SDL_Rect box = asset->bounding_box;
-      sdl_render_texture(texture, box);
+      sdl_render_sprite(sprite, box, 0, false);
     }
     break;
   }
   case ASSET_FONT: {
     SDL_Rect box = asset->bounding_box;
-    TTF_Font *font = ((text_asset_t *)asset)->font;
-    const char *msg = ((text_asset_t *)asset)->text;
-    rgb_color_t color = ((text_asset_t *)asset)->color;
-    SDL_Texture *texture = sdl_load_text_texture(font, msg, color);
-    sdl_render_texture(texture, box);
+    text_asset_t *text_asset = (text_asset_t *)asset;
+    // the glyph atlas draws most text without rasterizing anything; text it
+    // doesn't cover falls back to a texture of the whole string
+    glyph_atlas_t *atlas = glyph_atlas_get(text_asset->font);
+    if (atlas != NULL && glyph_atlas_draw_text(atlas, text_asset->text, box,
+                                               text_asset->color)) {
+      break;
+    }
+    text_asset_update_texture(text_asset);
+    sdl_render_texture(text_asset->texture, box);
     break;
   }
   case ASSET_BUTTON: {
@@ -263,4 +305,11 @@ char *asset_get_text(asset_t *asset) {
 
 SDL_Rect asset_get_bounding_box(asset_t *asset) { return asset->bounding_box; }
 
-void asset_destroy(asset_t *asset) { free(asset); }
+void asset_destroy(asset_t *asset) {
+  if (asset->type == ASSET_FONT &&
+      ((text_asset_t *)asset)->rendered_text != NULL) {
+    sdl_destroy_texture(((text_asset_t *)asset)->texture);
+    free(((text_asset_t *)asset)->rendered_text);
+  }
+  free(asset);
+}
@@ -1,36 +1,56 @@
 #include <SDL2/SDL_image.h>
 #include <SDL2/SDL_ttf.h>
 #include <assert.h>
+#include <stdint.h>
+#include <string.h>
 
 #include "asset.h"
 #include "asset_cache.h"
+#include "glyph_atlas.h"
 #include "list.h"
+#include "sprite_atlas.h"
 
-static list_t *ASSET_CACHE;
-
-const size_t FONT_SIZE = 18;
-const size_t INITIAL_CAPACITY = 5;
-
+/**
+ * A slot of the table. Empty slots have a NULL filepath.
+ * The cache owns filepath, its own copy of the path it was loaded from.
+ */
 typedef struct {
-  asset_type_t type;
+  uint64_t hash;
   const char *filepath;
+  asset_type_t type;
   void *obj;
 } entry_t;
 
+// open-addressing hash table of loaded assets, keyed by a copy of the filepath
+static entry_t *ASSET_CACHE;
+static size_t CACHE_CAPACITY;
+static size_t CACHE_SIZE;
+// registered buttons, which have no filepath
+static list_t *BUTTONS;
+// the atlases that the cached images' sprites are cut from
+static list_t *SPRITE_ATLASES;
+
+const size_t FONT_SIZE = 18;
+const size_t INITIAL_CAPACITY = 64; // a power of 2
+const size_t INITIAL_BUTTONS = 5;
+const size_t INITIAL_ATLASES = 2;
+// grow once more than 3/4 of the slots are used, to keep probes short
+const size_t MAX_LOAD_NUM = 3;
+const size_t MAX_LOAD_DEN = 4;
+const uint64_t PATH_HASH_OFFSET = 0xcbf29ce484222325ULL;
+const uint64_t PATH_HASH_PRIME = 0x100000001b3ULL;
+
 static void asset_cache_free_entry(entry_t *entry) {
   switch (entry->type) {
   case ASSET_IMAGE: {
-    SDL_DestroyTexture(entry->obj);
+    // the texture belongs to the sprite's atlas
+    free(entry->obj);
     break;
   }
   case ASSET_FONT: {
     TTF_CloseFont(entry->obj);
     break;
   }
-  case ASSET_BUTTON: {
-    free(entry->obj);
-    break;
-  }
   case ASSET_MUSIC: {
     Mix_FreeMusic(entry->obj);
     break;
@@ -39,92 +59,185 @@ static void asset_cache_free_entry(entry_t *entry) {
     Mix_FreeChunk(entry->obj);
     break;
   }
+  default:
+    break;
   }
-  free(entry);
+  free((char *)entry->filepath);
+}
+
+static entry_t *table_init(size_t capacity) {
+  entry_t *table = calloc(capacity, sizeof(entry_t));
+  assert(table);
+  return table;
 }
 
 void asset_cache_init() {
-  ASSET_CACHE =
-      list_init(INITIAL_CAPACITY, (free_func_t)asset_cache_free_entry);
+  CACHE_CAPACITY = INITIAL_CAPACITY;
+  CACHE_SIZE = 0;
+  ASSET_CACHE = table_init(CACHE_CAPACITY);
+  BUTTONS = list_init(INITIAL_BUTTONS, free);
+  SPRITE_ATLASES =
+      list_init(INITIAL_ATLASES, (free_func_t)sprite_atlas_free);
 }
 
-void asset_cache_destroy() { list_free(ASSET_CACHE); }
+void asset_cache_destroy() {
+  // the atlases reference the cached fonts
+  glyph_atlas_destroy_all();
+  for (size_t i = 0; i < CACHE_CAPACITY; i++) {
+    if (ASSET_CACHE[i].filepath != NULL) {
+      asset_cache_free_entry(&ASSET_CACHE[i]);
+    }
+  }
+  free(ASSET_CACHE);
+  list_free(BUTTONS);
+  list_free(SPRITE_ATLASES);
+}
 
-entry_t *cache_contains_path(const char *filepath) {
-  if (!filepath) {
-    return NULL;
+/**
+ * Hashes a filepath with 64-bit FNV-1a.
+ */
+static uint64_t hash_path(const char *filepath) {
+  uint64_t hash = PATH_HASH_OFFSET;
+  for (const char *c = filepath; *c != '\0'; c++) {
+    hash = (hash ^ (unsigned char)*c) * PATH_HASH_PRIME;
   }
-  for (size_t i = 0; i < list_size(ASSET_CACHE); i++) {
-    entry_t *entry = list_get(ASSET_CACHE, i);
-    if (entry->filepath != NULL && strcmp(entry->filepath, filepath) == 0) {
+  return hash;
+}
+
+/**
+ * Finds the slot holding a filepath, or the empty slot where it belongs.
+ * Entries are never removed before the cache is destroyed,
+ * so the probe can stop at the first empty slot.
+ */
+static entry_t *find_slot(entry_t *table, size_t capacity, uint64_t hash,
+                          const char *filepath) {
+  size_t mask = capacity - 1;
+  for (size_t i = hash & mask;; i = (i + 1) & mask) {
+    entry_t *entry = &table[i];
+    // comparing hashes first skips the strcmp() for nearly every other entry
+    if (entry->filepath == NULL ||
+        (entry->hash == hash && strcmp(entry->filepath, filepath) == 0)) {
       return entry;
     }
   }
-  return NULL;
 }
 
-entry_t *entry_init(asset_type_t type, const char *filepath, void *obj) {
-  entry_t *entry = malloc(sizeof(entry_t));
-  assert(entry);
-  entry->type = type;
-  entry->filepath = filepath;
-  entry->obj = obj;
-  return entry;
+/**
+ * Doubles the number of slots, rehashing every entry into the new table.
+ */
+static void asset_cache_grow() {
+  size_t capacity = CACHE_CAPACITY * 2;
+  entry_t *table = table_init(capacity);
+  for (size_t i = 0; i < CACHE_CAPACITY; i++) {
+    entry_t *entry = &ASSET_CACHE[i];
+    if (entry->filepath != NULL) {
+      *find_slot(table, capacity, entry->hash, entry->filepath) = *entry;
+    }
+  }
+  free(ASSET_CACHE);
+  ASSET_CACHE = table;
+  CACHE_CAPACITY = capacity;
 }
 
-void *asset_cache_obj_get_or_create(asset_type_t ty, const char *filepath) {
-  entry_t *entry = cache_contains_path(filepath);
-  if (entry) {
-    assert(entry->type == ty);
-    return entry->obj;
-  }
+/**
+ * Copies a filepath, so the cache's key outlives the caller's string.
+ */
+static const char *copy_path(const char *filepath) {
+  size_t length = strlen(filepath) + 1;
+  char *copy = malloc(length);
+  assert(copy);
+  memcpy(copy, filepath, length);
+  return copy;
+}
+
+static sprite_t *sprite_copy(sprite_t sprite) {
+  sprite_t *copy = malloc(sizeof(sprite_t));
+  assert(copy);
+  *copy = sprite;
+  return copy;
+}
+
+static void *asset_load(asset_type_t ty, const char *filepath) {
   switch (ty) {
   case ASSET_IMAGE: {
-    SDL_Texture *image = sdl_load_img_texture(filepath);
-    entry_t *entry = entry_init(ty, filepath, image);
-    list_add(ASSET_CACHE, entry);
-    return image;
+    // an image that wasn't packed by asset_cache_pack_images() gets an atlas
+    // of its own
+    sprite_atlas_t *atlas = sprite_atlas_build(&filepath, 1);
+    list_add(SPRITE_ATLASES, atlas);
+    return sprite_copy(sprite_atlas_get(atlas, 0));
   }
-  case ASSET_FONT: {
-    TTF_Font *text = TTF_OpenFont(filepath, FONT_SIZE);
-    entry_t *entry = entry_init(ty, filepath, text);
-    list_add(ASSET_CACHE, entry);
-    return text;
+  case ASSET_FONT:
+    return TTF_OpenFont(filepath, FONT_SIZE);
+  case ASSET_MUSIC:
+    return Mix_LoadMUS(filepath);
+  case ASSET_SFX:
+    return Mix_LoadWAV(filepath);
+  default:
+    return NULL;
   }
-  case ASSET_MUSIC: {
-    Mix_Music *music = Mix_LoadMUS(filepath);
-    entry_t *entry = entry_init(ty, filepath, music);
-    list_add(ASSET_CACHE, entry);
-    return music;
+}
+
+/**
+ * Adds an entry for a filepath that isn't cached yet,
+ * growing the table first if it is too full.
+ */
+static void cache_insert(uint64_t hash, const char *filepath, asset_type_t ty,
+                         void *obj) {
+  if ((CACHE_SIZE + 1) * MAX_LOAD_DEN > CACHE_CAPACITY * MAX_LOAD_NUM) {
+    asset_cache_grow();
   }
-  case ASSET_SFX: {
-    Mix_Music *sfx = Mix_LoadWAV(filepath);
-    entry_t *entry = entry_init(ty, filepath, sfx);
-    list_add(ASSET_CACHE, entry);
-    return sfx;
+  entry_t *entry = find_slot(ASSET_CACHE, CACHE_CAPACITY, hash, filepath);
+  assert(entry->filepath == NULL);
+  entry->hash = hash;
+  entry->filepath = copy_path(filepath);
+  entry->type = ty;
+  entry->obj = obj;
+  CACHE_SIZE++;
+}
+
+void *asset_cache_obj_get_or_create(asset_type_t ty, const char *filepath) {
+  assert(filepath);
+  uint64_t hash = hash_path(filepath);
+  entry_t *entry = find_slot(ASSET_CACHE, CACHE_CAPACITY, hash, filepath);
+  if (entry->filepath != NULL) {
+    assert(entry->type == ty);
+    return entry->obj;
   }
-  default:
+  if (ty == ASSET_BUTTON) {
     return NULL;
   }
+
+  void *obj = asset_load(ty, filepath);
+  cache_insert(hash, filepath, ty, obj);
+  return obj;
 }
 
-void asset_cache_register_button(asset_t *button) {
-  assert(asset_get_type(button) == ASSET_BUTTON);
+void asset_cache_pack_images(const char **filepaths, size_t num_paths) {
+  sprite_atlas_t *atlas = sprite_atlas_build(filepaths, num_paths);
+  list_add(SPRITE_ATLASES, atlas);
+  for (size_t i = 0; i < num_paths; i++) {
+    uint64_t hash = hash_path(filepaths[i]);
+    entry_t *entry =
+        find_slot(ASSET_CACHE, CACHE_CAPACITY, hash, filepaths[i]);
+    if (entry->filepath != NULL) {
+      // already loaded, and maybe already handed out, so keep it
+      assert(entry->type == ASSET_IMAGE);
+      continue;
+    }
+    cache_insert(hash, filepaths[i], ASSET_IMAGE,
+                 sprite_copy(sprite_atlas_get(atlas, i)));
+  }
+}
 
-  entry_t *entry = malloc(sizeof(entry_t));
-  assert(entry);
+size_t asset_cache_size() { return CACHE_SIZE; }
 
-  entry->filepath = NULL;
-  entry->obj = button;
-  entry->type = ASSET_BUTTON;
-  list_add(ASSET_CACHE, entry);
+void asset_cache_register_button(asset_t *button) {
+  assert(asset_get_type(button) == ASSET_BUTTON);
+  list_add(BUTTONS, button);
 }
 
 void asset_cache_handle_buttons(state_t *state, double x, double y) {
-  for (size_t i = 0; i < list_size(ASSET_CACHE); i++) {
-    entry_t *entry = list_get(ASSET_CACHE, i);
-    if (entry->type == ASSET_BUTTON) {
-      asset_on_button_click((asset_t *)entry->obj, state, x, y);
-    }
+  for (size_t i = 0; i < list_size(BUTTONS); i++) {
+    asset_on_button_click(list_get(BUTTONS, i), state, x, y);
   }
 }
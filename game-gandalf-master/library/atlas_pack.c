@@ -0,0 +1,166 @@
+#include <assert.h>
+#include <stdlib.h>
+
+#include "atlas_pack.h"
+#include "sdl_wrapper.h"
+
+// within the texture size limit of practically every GPU, WebGL included
+const int ATLAS_PAGE_SIZE = 4096;
+// empty pixels between images, so scaling one doesn't bleed its neighbours in
+const int ATLAS_PADDING = 1;
+
+/**
+ * An image waiting to be placed, and the page it is placed on.
+ */
+typedef struct placement {
+  size_t index;
+  SDL_Surface *surface;
+  size_t page;
+} placement_t;
+
+/**
+ * Orders placements by decreasing height, so each shelf is filled with
+ * images of similar height and wastes little space above the shorter ones.
+ */
+static int compare_heights(const void *a, const void *b) {
+  int height_a = ((const placement_t *)a)->surface->h;
+  int height_b = ((const placement_t *)b)->surface->h;
+  return (height_a < height_b) - (height_a > height_b);
+}
+
+/**
+ * A row of images on a page, filled left to right.
+ */
+typedef struct shelf {
+  size_t page;
+  int y;
+  int height;
+  int width; // the width used so far
+} shelf_t;
+
+/**
+ * The pages being laid out: the size each needs so far, i.e. the bottom
+ * right corner of its lowest shelf.
+ */
+typedef struct layout {
+  SDL_Rect *sizes;
+  size_t num_pages;
+  shelf_t *shelves;
+  size_t num_shelves;
+} layout_t;
+
+static size_t layout_add_page(layout_t *layout, int width, int height) {
+  layout->sizes =
+      realloc(layout->sizes, sizeof(SDL_Rect) * (layout->num_pages + 1));
+  assert(layout->sizes);
+  layout->sizes[layout->num_pages] = (SDL_Rect){0, 0, width, height};
+  return layout->num_pages++;
+}
+
+/**
+ * Finds a place for an image: at the end of the first shelf it fits on,
+ * otherwise on a new shelf under the first page's shelves that have room,
+ * otherwise on a new page. Shelves are as tall as their first image, so
+ * placing images tallest first wastes little space above the others.
+ */
+static size_t layout_place(layout_t *layout, SDL_Rect *region) {
+  if (region->w > ATLAS_PAGE_SIZE || region->h > ATLAS_PAGE_SIZE) {
+    return layout_add_page(layout, region->w, region->h);
+  }
+  for (size_t i = 0; i < layout->num_shelves; i++) {
+    shelf_t *shelf = &layout->shelves[i];
+    if (region->h <= shelf->height &&
+        shelf->width + region->w <= ATLAS_PAGE_SIZE) {
+      region->x = shelf->width;
+      region->y = shelf->y;
+      shelf->width += region->w + ATLAS_PADDING;
+      SDL_Rect *size = &layout->sizes[shelf->page];
+      if (region->x + region->w > size->w) {
+        size->w = region->x + region->w;
+      }
+      return shelf->page;
+    }
+  }
+
+  size_t page = 0;
+  int y = 0;
+  while (page < layout->num_pages) {
+    // oversized pages are full, with a size bigger than ATLAS_PAGE_SIZE
+    y = layout->sizes[page].h == 0 ? 0
+                                   : layout->sizes[page].h + ATLAS_PADDING;
+    if (y + region->h <= ATLAS_PAGE_SIZE) {
+      break;
+    }
+    page++;
+  }
+  if (page == layout->num_pages) {
+    layout_add_page(layout, 0, 0);
+    y = 0;
+  }
+  layout->shelves = realloc(layout->shelves,
+                            sizeof(shelf_t) * (layout->num_shelves + 1));
+  assert(layout->shelves);
+  layout->shelves[layout->num_shelves++] =
+      (shelf_t){page, y, region->h, region->w + ATLAS_PADDING};
+  region->x = 0;
+  region->y = y;
+  SDL_Rect *size = &layout->sizes[page];
+  size->h = y + region->h;
+  if (region->w > size->w) {
+    size->w = region->w;
+  }
+  return page;
+}
+
+SDL_Texture **atlas_pack_images(SDL_Surface **images, size_t num_images,
+                                sprite_t *sprites, size_t *num_pages) {
+  placement_t *placements = malloc(sizeof(placement_t) * (num_images + 1));
+  assert(placements);
+  size_t num_placed = 0;
+  for (size_t i = 0; i < num_images; i++) {
+    sprites[i] = (sprite_t){NULL, {0, 0, 0, 0}};
+    if (images[i] != NULL) {
+      placements[num_placed++] = (placement_t){i, images[i], 0};
+    }
+  }
+  qsort(placements, num_placed, sizeof(placement_t), compare_heights);
+
+  layout_t layout = {NULL, 0, NULL, 0};
+  for (size_t i = 0; i < num_placed; i++) {
+    placement_t *placement = &placements[i];
+    SDL_Rect region = {0, 0, placement->surface->w, placement->surface->h};
+    placement->page = layout_place(&layout, &region);
+    sprites[placement->index].region = region;
+  }
+  free(layout.shelves);
+
+  // draw each page's images onto it, then upload it
+  SDL_Texture **pages = malloc(sizeof(SDL_Texture *) * (layout.num_pages + 1));
+  assert(pages);
+  for (size_t page = 0; page < layout.num_pages; page++) {
+    SDL_Surface *sheet =
+        SDL_CreateRGBSurfaceWithFormat(0, layout.sizes[page].w,
+                                       layout.sizes[page].h, 32,
+                                       SDL_PIXELFORMAT_RGBA32);
+    assert(sheet);
+    for (size_t i = 0; i < num_placed; i++) {
+      if (placements[i].page != page) {
+        continue;
+      }
+      // copy the image's alpha as is, instead of blending it over the sheet
+      SDL_SetSurfaceBlendMode(placements[i].surface, SDL_BLENDMODE_NONE);
+      SDL_Rect region = sprites[placements[i].index].region;
+      SDL_BlitSurface(placements[i].surface, NULL, sheet, &region);
+    }
+    pages[page] = sdl_load_surface_texture(sheet);
+    SDL_FreeSurface(sheet);
+  }
+  for (size_t i = 0; i < num_placed; i++) {
+    sprites[placements[i].index].texture = pages[placements[i].page];
+    SDL_FreeSurface(placements[i].surface);
+  }
+  free(placements);
+  free(layout.sizes);
+  *num_pages = layout.num_pages;
+  return pages;
+}
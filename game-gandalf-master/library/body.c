@@ -6,42 +6,117 @@
 #include <math.h>
 
 const double TWO_PI = 2 * M_PI;
+const size_t INITIAL_NUM_FORCE_CREATORS = 2;
+const size_t INITIAL_FORCE_LOG_SIZE = 64;
+
+typedef struct body_state {
+  vector_t position;
+  vector_t velocity;
+  vector_t force;
+  vector_t impulse;
+  double inverse_mass;
+  double angle;
+  double angular_velocity;
+  vector_t prev_position;
+  double prev_angle;
+} body_state_t;
 
 struct body {
   polygon_t *poly;
 
   double mass;
 
-  vector_t force;
-  vector_t impulse;
+  // where the body's dynamic state lives: the arrays of the scene it is in,
+  // or `own_arrays`, which point into `own_state`, before it is added to one
+  body_arrays_t *arrays;
+  size_t slot;
+  body_arrays_t own_arrays;
+  body_state_t own_state;
+
   bool removed;
-  double direction_angle;
+  uint32_t category;
+  // the force creators of the body's scene that act on it, NULL if none
+  list_t *force_creators;
 
   void *info;
   free_func_t info_freer;
 };
 
+typedef struct force_log_entry {
+  body_t *body;
+  vector_t amount;
+  bool impulse;
+} force_log_entry_t;
+
+struct force_log {
+  force_log_entry_t *entries;
+  size_t size;
+  size_t capacity;
+};
+
+// the force log body_add_force() and body_add_impulse() append to on this
+// thread, or NULL to change the bodies directly
+static _Thread_local force_log_t *active_force_log = NULL;
+
 body_t *body_init(list_t *shape, double mass, rgb_color_t color) {
   return body_init_with_info(shape, mass, color, NULL, NULL, 0);
 }
 
-body_t *body_init_with_info(list_t *shape, double mass, rgb_color_t color,
-                            void *info, free_func_t info_freer,
-                            double direction_angle) {
+/**
+ * Allocates a body around an already initialized polygon.
+ */
+static body_t *body_init_with_polygon(polygon_t *poly, double mass,
+                                      void *info, free_func_t info_freer,
+                                      double direction_angle) {
   body_t *body = malloc(sizeof(body_t));
   assert(body);
 
-  body->poly = polygon_init(shape, VEC_ZERO, 0.0, color.r, color.g, color.b);
+  body->poly = poly;
   body->mass = mass;
-  body->force = VEC_ZERO;
-  body->impulse = VEC_ZERO;
+  body->own_state = (body_state_t){.position = polygon_get_center(poly),
+                                   .velocity = VEC_ZERO,
+                                   .force = VEC_ZERO,
+                                   .impulse = VEC_ZERO,
+                                   .inverse_mass = 1.0 / mass,
+                                   .angle = direction_angle,
+                                   .angular_velocity = 0,
+                                   .prev_position = polygon_get_center(poly),
+                                   .prev_angle = direction_angle};
+  body->own_arrays = (body_arrays_t){&body->own_state.position,
+                                     &body->own_state.velocity,
+                                     &body->own_state.force,
+                                     &body->own_state.impulse,
+                                     &body->own_state.inverse_mass,
+                                     &body->own_state.angle,
+                                     &body->own_state.angular_velocity,
+                                     &body->own_state.prev_position,
+                                     &body->own_state.prev_angle};
+  body->arrays = &body->own_arrays;
+  body->slot = 0;
   body->removed = false;
   body->info = info;
   body->info_freer = info_freer;
-  body->direction_angle = direction_angle;
+  body->category = 0;
+  body->force_creators = NULL;
   return body;
 }
 
+body_t *body_init_with_info(list_t *shape, double mass, rgb_color_t color,
+                            void *info, free_func_t info_freer,
+                            double direction_angle) {
+  polygon_t *poly =
+      polygon_init(shape, VEC_ZERO, 0.0, color.r, color.g, color.b);
+  return body_init_with_polygon(poly, mass, info, info_freer, direction_angle);
+}
+
+body_t *body_init_with_shape(shape_t *shape, vector_t centroid, double mass,
+                             rgb_color_t color, void *info,
+                             free_func_t info_freer, double direction_angle) {
+  polygon_t *poly = polygon_init_with_shape(shape, centroid, VEC_ZERO, 0.0,
+                                            color.r, color.g, color.b);
+  return body_init_with_polygon(poly, mass, info, info_freer, direction_angle);
+}
+
 void body_free(body_t *body) {
   if (body == NULL) {
     return;
@@ -52,6 +127,9 @@ void body_free(body_t *body) {
   if (body->info_freer != NULL) {
     body->info_freer(body->info);
   }
+  if (body->force_creators != NULL) {
+    list_free(body->force_creators);
+  }
   free(body);
 }
 
@@ -61,9 +139,7 @@ void body_free(body_t *body) {
  * @return angle bounded between 0 and 2pi
  */
 double simplify_angle(double angle) {
-  ssize_t n = (ssize_t)(angle / TWO_PI);
-  angle = angle - n * TWO_PI;
-  return angle;
+  return angle - trunc(angle / TWO_PI) * TWO_PI;
 }
 
 /**
@@ -73,33 +149,62 @@ double simplify_angle(double angle) {
  * @param angle in radians to rotate body by
  */
 void body_rotate_direction(body_t *body, double angle) {
-  double direction = body->direction_angle;
-  body->direction_angle = simplify_angle(direction + angle);
+  double *direction = &body->arrays->angle[body->slot];
+  *direction = simplify_angle(*direction + angle);
+  body->arrays->prev_angle[body->slot] = *direction;
+}
+
+/**
+ * Moves the polygon to the body's current position.
+ * The position is only stored in the body's arrays, so the polygon has to be
+ * caught up before anything reads its vertices or bounds.
+ */
+static polygon_t *body_sync_polygon(body_t *body) {
+  vector_t position = body->arrays->position[body->slot];
+  vector_t center = polygon_get_center(body->poly);
+  // skipping the write when nothing moved keeps this read-only once synced,
+  // so the scene's narrowphase can call it from several threads
+  if (position.x != center.x || position.y != center.y) {
+    polygon_set_center(body->poly, position);
+  }
+  return body->poly;
 }
 
 list_t *body_get_shape(body_t *body) {
-  polygon_t *polygon = body->poly;
-  list_t *points = polygon_get_points(polygon);
-  list_t *shape = list_init(list_size(points), free);
-  for (size_t i = 0; i < list_size(points); i++) {
-    vector_t *vec = list_get(points, i);
-    assert(vec);
+  polygon_t *polygon = body_sync_polygon(body);
+  const vector_t *vertices = polygon_get_vertices(polygon);
+  size_t num_vertices = polygon_num_vertices(polygon);
+  list_t *shape = list_init(num_vertices, free);
+  for (size_t i = 0; i < num_vertices; i++) {
     vector_t *new_vec = malloc(sizeof(vector_t));
     assert(new_vec);
-    new_vec->x = vec->x;
-    new_vec->y = vec->y;
+    *new_vec = vertices[i];
     list_add(shape, new_vec);
   }
   return shape;
 }
 
 vector_t body_get_centroid(body_t *body) {
-  return polygon_get_center(body->poly);
+  return body->arrays->position[body->slot];
+}
+
+vector_t body_get_interpolated_centroid(body_t *body, double alpha) {
+  vector_t prev = body->arrays->prev_position[body->slot];
+  vector_t current = body->arrays->position[body->slot];
+  return (vector_t){prev.x + alpha * (current.x - prev.x),
+                    prev.y + alpha * (current.y - prev.y)};
+}
+
+double body_get_interpolated_direction_angle(body_t *body, double alpha) {
+  double prev = body->arrays->prev_angle[body->slot];
+  double turned = body->arrays->angle[body->slot] - prev;
+  // angles are kept in [0, 2pi), so a small turn can look like almost 2pi
+  turned -= round(turned / TWO_PI) * TWO_PI;
+  return prev + alpha * turned;
 }
 
 vector_t body_get_velocity(body_t *body) {
-  polygon_t *poly = body->poly;
-  return polygon_get_velocity(poly);
+  return body->arrays->velocity[body->slot];
 }
 
 rgb_color_t *body_get_color(body_t *body) {
@@ -107,16 +212,16 @@ rgb_color_t *body_get_color(body_t *body) {
 }
 
 double body_get_rotation_speed(body_t *body) {
-  return polygon_get_rotation(body->poly);
+  return body->arrays->angular_velocity[body->slot];
 }
 
 void body_set_rotation_speed(body_t *body, double rotation_speed) {
-  polygon_set_rotation(body->poly, rotation_speed);
+  body->arrays->angular_velocity[body->slot] = rotation_speed;
 }
 
 double body_get_mass(body_t *body) { return body->mass; }
 
-polygon_t *body_get_polygon(body_t *body) { return body->poly; }
+polygon_t *body_get_polygon(body_t *body) { return body_sync_polygon(body); }
 
 void *body_get_info(body_t *body) { return body->info; }
 
@@ -125,53 +230,118 @@ void body_set_color(body_t *body, rgb_color_t *col) {
 }
 
 void body_set_centroid(body_t *body, vector_t x) {
-  vector_t old_centroid = polygon_get_center(body->poly);
-  vector_t diff = vec_subtract(x, old_centroid);
-  polygon_translate(body->poly, diff);
-  polygon_set_center(body->poly, x);
+  body->arrays->position[body->slot] = x;
+  body->arrays->prev_position[body->slot] = x;
 }
 
 void body_set_velocity(body_t *body, vector_t v) {
-  polygon_set_velocity(body->poly, v);
+  body->arrays->velocity[body->slot] = v;
 }
 
 void body_set_rotation(body_t *body, double angle) {
-  body_rotate_direction(body, angle - body->direction_angle);
-  polygon_rotate(body->poly, angle, body_get_centroid(body));
+  body_rotate_direction(body, angle - body_get_direction_angle(body));
+  polygon_rotate(body_sync_polygon(body), angle, body_get_centroid(body));
+}
+
+void body_arrays_integrate(body_arrays_t *arrays, size_t start, size_t end,
+                           double dt) {
+  vector_t *restrict position = arrays->position;
+  vector_t *restrict velocity = arrays->velocity;
+  vector_t *restrict force = arrays->force;
+  vector_t *restrict impulse = arrays->impulse;
+  const double *restrict inverse_mass = arrays->inverse_mass;
+  double *restrict angle = arrays->angle;
+  const double *restrict angular_velocity = arrays->angular_velocity;
+  vector_t *restrict prev_position = arrays->prev_position;
+  double *restrict prev_angle = arrays->prev_angle;
+
+  for (size_t i = start; i < end; i++) {
+    // impulse = m * dv and force = m * (dv / dt)
+    double dv_x = (impulse[i].x + dt * force[i].x) * inverse_mass[i];
+    double dv_y = (impulse[i].y + dt * force[i].y) * inverse_mass[i];
+    impulse[i] = VEC_ZERO;
+    force[i] = VEC_ZERO;
+
+    vector_t old_vel = velocity[i];
+    vector_t new_vel = {old_vel.x + dv_x, old_vel.y + dv_y};
+    velocity[i] = new_vel;
+
+    prev_position[i] = position[i];
+    prev_angle[i] = angle[i];
+
+    // translate at the average of the velocities before and after the tick
+    position[i].x += dt * 0.5 * (old_vel.x + new_vel.x);
+    position[i].y += dt * 0.5 * (old_vel.y + new_vel.y);
+
+    double turned = simplify_angle(angle[i] + angular_velocity[i] * dt);
+    angle[i] = angular_velocity[i] != 0 ? turned : angle[i];
+  }
 }
 
 void body_tick(body_t *body, double dt) {
-  // impulse = m * dv
-  vector_t impulse_dv = vec_multiply(1.0 / body->mass, body->impulse);
-  // force = m * (dv / dt)
-  vector_t force_dv = vec_multiply(dt / body->mass, body->force);
+  body_arrays_integrate(body->arrays, body->slot, body->slot + 1, dt);
+}
+
+force_log_t *force_log_init(void) {
+  force_log_t *log = malloc(sizeof(force_log_t));
+  assert(log);
+  log->entries = malloc(sizeof(force_log_entry_t) * INITIAL_FORCE_LOG_SIZE);
+  assert(log->entries);
+  log->size = 0;
+  log->capacity = INITIAL_FORCE_LOG_SIZE;
+  return log;
+}
 
-  body->impulse = VEC_ZERO;
-  body->force = VEC_ZERO;
+void force_log_free(force_log_t *log) {
+  free(log->entries);
+  free(log);
+}
 
-  vector_t dv = vec_add(impulse_dv, force_dv);
+void force_log_begin(force_log_t *log) { active_force_log = log; }
 
-  vector_t old_vel = body_get_velocity(body);
-  vector_t new_vel = vec_add(old_vel, dv);
-  body_set_velocity(body, new_vel);
+void force_log_end(void) { active_force_log = NULL; }
 
-  double ang_vel = body_get_rotation_speed(body);
-  if (ang_vel != 0) {
-    double ang_dis = ang_vel * dt;
-    body_rotate_direction(body, ang_dis);
+/**
+ * Appends a force or impulse to a force log.
+ */
+static void force_log_add(force_log_t *log, body_t *body, vector_t amount,
+                          bool impulse) {
+  if (log->size == log->capacity) {
+    log->capacity *= 2;
+    log->entries =
+        realloc(log->entries, sizeof(force_log_entry_t) * log->capacity);
+    assert(log->entries);
   }
+  log->entries[log->size++] = (force_log_entry_t){body, amount, impulse};
+}
 
-  vector_t ave_vel = vec_multiply(0.5, vec_add(old_vel, new_vel));
-  body_set_centroid(
-      body, vec_add(body_get_centroid(body), vec_multiply(dt, ave_vel)));
+void force_log_apply(force_log_t *log) {
+  for (size_t i = 0; i < log->size; i++) {
+    force_log_entry_t *entry = &log->entries[i];
+    body_t *body = entry->body;
+    vector_t *total = entry->impulse ? &body->arrays->impulse[body->slot]
+                                     : &body->arrays->force[body->slot];
+    *total = vec_add(*total, entry->amount);
+  }
+  log->size = 0;
 }
 
 void body_add_force(body_t *body, vector_t force) {
-  body->force = vec_add(body->force, force);
+  if (active_force_log != NULL) {
+    force_log_add(active_force_log, body, force, false);
+    return;
+  }
+  vector_t *total = &body->arrays->force[body->slot];
+  *total = vec_add(*total, force);
 }
 
 void body_add_impulse(body_t *body, vector_t impulse) {
-  body->impulse = vec_add(body->impulse, impulse);
+  if (active_force_log != NULL) {
+    force_log_add(active_force_log, body, impulse, true);
+    return;
+  }
+  vector_t *total = &body->arrays->impulse[body->slot];
+  *total = vec_add(*total, impulse);
 }
 
 void body_remove(body_t *body) { body->removed = true; }
@@ -179,11 +349,64 @@ void body_remove(body_t *body) { body->removed = true; }
 bool body_is_removed(body_t *body) { return body->removed; }
 
 void body_reset(body_t *body) {
-  body->force = VEC_ZERO;
-  body->impulse = VEC_ZERO;
+  body->arrays->force[body->slot] = VEC_ZERO;
+  body->arrays->impulse[body->slot] = VEC_ZERO;
 }
 
-double body_get_direction_angle(body_t *body) { return body->direction_angle; }
+void body_add_force_creator(body_t *body, struct fcreator_storer *storer) {
+  if (body->force_creators == NULL) {
+    body->force_creators = list_init(INITIAL_NUM_FORCE_CREATORS, NULL);
+  }
+  list_add(body->force_creators, storer);
+}
+
+void body_remove_force_creator(body_t *body, struct fcreator_storer *storer) {
+  list_t *storers = body->force_creators;
+  size_t size = storers == NULL ? 0 : list_size(storers);
+  for (size_t i = 0; i < size; i++) {
+    if (list_get(storers, i) == storer) {
+      // order doesn't matter, so move the last one into the hole
+      list_set(storers, list_get(storers, size - 1), i);
+      list_remove(storers, size - 1);
+      return;
+    }
+  }
+}
+
+size_t body_num_force_creators(body_t *body) {
+  return body->force_creators == NULL ? 0 : list_size(body->force_creators);
+}
+
+struct fcreator_storer *body_get_force_creator(body_t *body, size_t index) {
+  assert(index < body_num_force_creators(body));
+  return list_get(body->force_creators, index);
+}
+
+void body_attach(body_t *body, body_arrays_t *arrays, size_t slot) {
+  arrays->position[slot] = body_get_centroid(body);
+  arrays->velocity[slot] = body_get_velocity(body);
+  arrays->force[slot] = body->arrays->force[body->slot];
+  arrays->impulse[slot] = body->arrays->impulse[body->slot];
+  arrays->inverse_mass[slot] = body->arrays->inverse_mass[body->slot];
+  arrays->angle[slot] = body_get_direction_angle(body);
+  arrays->angular_velocity[slot] = body_get_rotation_speed(body);
+  arrays->prev_position[slot] = body->arrays->prev_position[body->slot];
+  arrays->prev_angle[slot] = body->arrays->prev_angle[body->slot];
+  body->arrays = arrays;
+  body->slot = slot;
+}
+
+void body_set_slot(body_t *body, size_t slot) { body->slot = slot; }
+
+double body_get_direction_angle(body_t *body) {
+  return body->arrays->angle[body->slot];
+}
+
+uint32_t body_get_category(body_t *body) { return body->category; }
+
+void body_set_category(body_t *body, uint32_t category) {
+  body->category = category;
+}
 
 void body_is_valid(body_t *body) {
   assert(body);
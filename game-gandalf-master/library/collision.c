@@ -6,40 +6,40 @@
 #include <stdlib.h>
 
 /**
- * Returns a list of vectors representing the edges of a shape.
- *
- * @param shape the list of vectors representing the vertices of a shape
- * @return a list of vectors representing the edges of the shape
+ * A view of a polygon's scene vertices as a contiguous array, along with its
+ * shape's precomputed edge normals and the rotation that takes them to the
+ * scene.
  */
-static list_t *get_edges(list_t *shape) {
-  list_t *edges = list_init(list_size(shape), free);
-
-  for (size_t i = 0; i < list_size(shape); i++) {
-    vector_t *vec = malloc(sizeof(vector_t));
-    assert(vec);
-    *vec =
-        vec_subtract(*(vector_t *)list_get(shape, i % list_size(shape)),
-                     *(vector_t *)list_get(shape, (i + 1) % list_size(shape)));
-    list_add(edges, vec);
-  }
-
-  return edges;
+typedef struct {
+  const vector_t *vertices;
+  const vector_t *normals;
+  size_t num_vertices;
+  double cos_angle;
+  double sin_angle;
+} shape_view_t;
+
+static shape_view_t shape_view_init(body_t *body) {
+  polygon_t *polygon = body_get_polygon(body);
+  double angle = polygon_get_angle(polygon);
+  return (shape_view_t){polygon_get_vertices(polygon),
+                        shape_get_normals(polygon_get_shape(polygon)),
+                        polygon_num_vertices(polygon), cos(angle), sin(angle)};
 }
 
 /**
  * Returns a vector containing the maximum and minimum length projections given
  * a unit axis and shape.
  *
- * @param shape the list of vectors representing the vertices of a shape
+ * @param shape the vertices of a shape
  * @param unit_axis the unit axis to project eeach vertex on
  * @return a vector in the form (max, min) where `max` is the maximum projection
  * length and `min` is the minimum projection length.
  */
-static vector_t get_max_min_projections(list_t *shape, vector_t unit_axis) {
+static vector_t get_max_min_projections(shape_view_t shape,
+                                        vector_t unit_axis) {
   vector_t max_min = (vector_t){-__DBL_MAX__, __DBL_MAX__};
-  for (size_t i = 0; i < list_size(shape); i++) {
-    vector_t *vertex = list_get(shape, i);
-    double projection_length = vec_dot(*vertex, unit_axis);
+  for (size_t i = 0; i < shape.num_vertices; i++) {
+    double projection_length = vec_dot(shape.vertices[i], unit_axis);
     if (projection_length < max_min.y) {
       max_min.y = projection_length;
     }
@@ -51,25 +51,29 @@ static vector_t get_max_min_projections(list_t *shape, vector_t unit_axis) {
 }
 
 /**
- * Determines whether two convex polygons intersect.
- * The polygons are given as lists of vertices in counterclockwise order.
+ * Determines whether two convex polygons intersect,
+ * testing the normals of the edges of the first shape as separating axes.
+ * The polygons are given as vertices in counterclockwise order.
  * There is an edge between each pair of consecutive vertices,
  * and one between the first vertex and the last vertex.
+ * The edge normals come from the shape, so nothing is computed per edge
+ * beyond rotating them into the scene.
  *
  * @param shape1 the first shape
  * @param shape2 the second shape
+ * @param min_overlap the smallest overlap found so far, updated in place
  * @return whether the shapes are colliding
  */
-static collision_info_t compare_collision(list_t *shape1, list_t *shape2,
+static collision_info_t compare_collision(shape_view_t shape1,
+                                          shape_view_t shape2,
                                           double *min_overlap) {
-  list_t *edges1 = get_edges(shape1);
   collision_info_t col_info = (collision_info_t){false, VEC_ZERO};
 
-  for (size_t i = 0; i < list_size(edges1); i++) {
-    vector_t *edge = list_get(edges1, i);
-    vector_t projection_axis = vec_rotate(*edge, M_PI / 2);
-    vector_t unit_vector =
-        vec_multiply(1.0 / vec_get_length(projection_axis), projection_axis);
+  for (size_t i = 0; i < shape1.num_vertices; i++) {
+    vector_t normal = shape1.normals[i];
+    vector_t unit_vector = {
+        normal.x * shape1.cos_angle - normal.y * shape1.sin_angle,
+        normal.x * shape1.sin_angle + normal.y * shape1.cos_angle};
 
     vector_t max_min_1 = get_max_min_projections(shape1, unit_vector);
     vector_t max_min_2 = get_max_min_projections(shape2, unit_vector);
@@ -83,7 +87,6 @@ static collision_info_t compare_collision(list_t *shape1, list_t *shape2,
     double small_overlap = overlap1 < overlap2 ? overlap1 : overlap2;
 
     if (small_overlap < 0) {
-      list_free(edges1);
       return col_info;
     }
 
@@ -96,29 +99,43 @@ static collision_info_t compare_collision(list_t *shape1, list_t *shape2,
   return col_info;
 }
 
+/**
+ * Returns whether two polygons are definitely apart,
+ * using only their cached bounding boxes and bounding circles.
+ */
+static bool bounds_disjoint(polygon_t *polygon1, polygon_t *polygon2) {
+  vector_t min1 = polygon_get_bounds_min(polygon1);
+  vector_t max1 = polygon_get_bounds_max(polygon1);
+  vector_t min2 = polygon_get_bounds_min(polygon2);
+  vector_t max2 = polygon_get_bounds_max(polygon2);
+  if (min1.x > max2.x || min2.x > max1.x || min1.y > max2.y ||
+      min2.y > max1.y) {
+    return true;
+  }
+  vector_t offset = vec_subtract(polygon_get_center(polygon2),
+                                 polygon_get_center(polygon1));
+  double radii = polygon_get_radius(polygon1) + polygon_get_radius(polygon2);
+  return vec_dot(offset, offset) > radii * radii;
+}
+
 collision_info_t find_collision(body_t *body1, body_t *body2) {
-  list_t *shape1 = body_get_shape(body1);
-  list_t *shape2 = body_get_shape(body2);
+  if (bounds_disjoint(body_get_polygon(body1), body_get_polygon(body2))) {
+    return (collision_info_t){false, VEC_ZERO};
+  }
+
+  shape_view_t shape1 = shape_view_init(body1);
+  shape_view_t shape2 = shape_view_init(body2);
 
   double c1_overlap = __DBL_MAX__;
   double c2_overlap = __DBL_MAX__;
 
-  collision_info_t collision1 = compare_collision(shape1, shape2, &c1_overlap);
-  collision_info_t collision2 = compare_collision(shape2, shape1, &c2_overlap);
-
-  list_free(shape1);
-  list_free(shape2);
-
-  if (!collision1.collided) {
-    return collision1;
-  }
-
-  if (!collision2.collided) {
-    return collision2;
-  }
-
-  if (c1_overlap < c2_overlap) {
-    return collision1;
+  collision_info_t result = compare_collision(shape1, shape2, &c1_overlap);
+  if (result.collided) {
+    collision_info_t collision2 =
+        compare_collision(shape2, shape1, &c2_overlap);
+    if (!collision2.collided || c2_overlap <= c1_overlap) {
+      result = collision2;
+    }
   }
-  return collision2;
+  return result;
 }
@@ -1,11 +1,10 @@
 #include <assert.h>
-#include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
 
 #include "color.h"
+#include "rng.h"
 
-const double COLOR_MAX = 255; // max value of each rgb value
 const double WHITE_MIX = 1;
 
 rgb_color_t *color_init(double red, double green, double blue) {
@@ -19,18 +18,13 @@ rgb_color_t *color_init(double red, double green, double blue) {
   return color;
 }
 
-rgb_color_t *color_get_random() {
-  double r = (double)rand();
-  double g = (double)rand();
-  double b = (double)rand();
+rgb_color_t *color_get_random(rng_t *rng) {
+  double rgb[3];
+  rng_fill_doubles(rng, rgb, 3);
 
-  r = fmod(r, COLOR_MAX) / COLOR_MAX;
-  g = fmod(g, COLOR_MAX) / COLOR_MAX;
-  b = fmod(b, COLOR_MAX) / COLOR_MAX;
-
-  r = (r + WHITE_MIX) / 2;
-  g = (g + WHITE_MIX) / 2;
-  b = (b + WHITE_MIX) / 2;
+  double r = (rgb[0] + WHITE_MIX) / 2;
+  double g = (rgb[1] + WHITE_MIX) / 2;
+  double b = (rgb[2] + WHITE_MIX) / 2;
 
   return color_init(r, g, b);
 }
@@ -3,6 +3,7 @@
 #include "state.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include <SDL2/SDL.h>
 #ifdef __EMSCRIPTEN__
@@ -29,15 +30,40 @@ void loop() {
 #endif
     return;
   } else if (game_over) {
+#ifdef __EMSCRIPTEN__
     SDL_Quit();
+#else
+    // natively, the game exits once the match is over, so that a recording
+    // ends where its replay does
+    sdl_finish();
+    emscripten_free(state);
+    exit(0);
+#endif
   }
 }
 
-int main() {
+int main(int argc, char *argv[]) {
 #ifdef __EMSCRIPTEN__
   // Set loop as the function emscripten calls to request a new frame
   emscripten_set_main_loop_arg(loop, NULL, 0, 1);
 #else
+  // 'bin/game --record FILE' records the match to FILE, and
+  // 'bin/game --replay FILE' replays it without a window, as fast as possible
+  if (argc == 3 && strcmp(argv[1], "--record") == 0) {
+    if (!sdl_record_input(argv[2])) {
+      fprintf(stderr, "Couldn't record to %s\n", argv[2]);
+      return 1;
+    }
+  } else if (argc == 3 && strcmp(argv[1], "--replay") == 0) {
+    if (!sdl_replay_input(argv[2])) {
+      fprintf(stderr, "Couldn't replay %s\n", argv[2]);
+      return 1;
+    }
+    sdl_set_render_backend(&RENDER_BACKEND_NULL);
+  } else if (argc != 1) {
+    fprintf(stderr, "Usage: %s [--record FILE | --replay FILE]\n", argv[0]);
+    return 1;
+  }
   while (1) {
     loop();
   }
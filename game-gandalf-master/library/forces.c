@@ -6,11 +6,14 @@
 #include <stdlib.h>
 
 const double MIN_DIST = 5;
+const size_t INITIAL_CATEGORY_BODIES = 8;
 
 struct fcreator_storer {
   force_creator_t creator;
   void *aux;
   list_t *bodies;
+  bool removed;
+  bool serial;
 };
 
 typedef struct body_aux {
@@ -18,12 +21,21 @@ typedef struct body_aux {
   list_t *bodies;
 } body_aux_t;
 
+typedef struct category_aux {
+  double force_const;
+  list_t *bodies; // scratch list, refilled with the category2 bodies each tick
+  uint32_t category1;
+  uint32_t category2;
+  scene_t *scene;
+} category_aux_t;
+
 typedef struct collision_aux {
   double force_const;
   list_t *bodies;
   collision_handler_t handler;
   bool collided;
   void *aux; // aux (if allocated in memory) should be free'd by the caller
+  scene_t *scene;
 } collision_aux_t;
 
 body_aux_t *body_aux_init(double force_const, list_t *bodies) {
@@ -38,7 +50,7 @@ body_aux_t *body_aux_init(double force_const, list_t *bodies) {
 
 collision_aux_t *collision_aux_init(double force_const, list_t *bodies,
                                     collision_handler_t handler, bool collided,
-                                    void *aux) {
+                                    void *aux, scene_t *scene) {
   collision_aux_t *collision_aux = malloc(sizeof(collision_aux_t));
   assert(collision_aux);
 
@@ -47,6 +59,7 @@ collision_aux_t *collision_aux_init(double force_const, list_t *bodies,
   collision_aux->handler = handler;
   collision_aux->collided = collided;
   collision_aux->aux = aux;
+  collision_aux->scene = scene;
   return collision_aux;
 }
 
@@ -65,6 +78,8 @@ fcreator_storer_t *fcreator_storer_init(force_creator_t creator, void *aux,
   storer->creator = creator;
   storer->aux = aux;
   storer->bodies = bodies;
+  storer->removed = false;
+  storer->serial = false;
   return storer;
 }
 
@@ -78,6 +93,22 @@ list_t *fcreator_storer_get_bodies(fcreator_storer_t *storer) {
   return storer->bodies;
 }
 
+void fcreator_storer_remove(fcreator_storer_t *storer) {
+  storer->removed = true;
+}
+
+bool fcreator_storer_is_removed(fcreator_storer_t *storer) {
+  return storer->removed;
+}
+
+void fcreator_storer_set_serial(fcreator_storer_t *storer) {
+  storer->serial = true;
+}
+
+bool fcreator_storer_is_serial(fcreator_storer_t *storer) {
+  return storer->serial;
+}
+
 void fcreator_storer_free(fcreator_storer_t *storer) {
   if (storer == NULL) {
     return;
@@ -92,32 +123,39 @@ void fcreator_storer_free(fcreator_storer_t *storer) {
 }
 
 /**
- * The force creator for gravitational forces between objects. Calculates
- * the magnitude of the force components and adds the force to each
- * associated body.
- *
- * @param info auxiliary information about the force and associated bodies
+ * Applies equal and opposite Newtonian gravitational forces to two bodies,
+ * unless they are closer than MIN_DIST.
  */
-static void newtonian_gravity(void *info) {
-  body_aux_t *aux = (body_aux_t *)info;
+static void apply_newtonian_gravity(double G, body_t *body1, body_t *body2) {
   vector_t displacement =
-      vec_subtract(body_get_centroid(list_get(aux->bodies, 0)),
-                   body_get_centroid(list_get(aux->bodies, 1)));
+      vec_subtract(body_get_centroid(body1), body_get_centroid(body2));
 
   double distance = vec_get_length(displacement);
   vector_t unit_disp = vec_multiply(1 / distance, displacement);
 
   if (distance > MIN_DIST) {
-    vector_t grav_force = vec_multiply(
-        aux->force_const * body_get_mass(list_get(aux->bodies, 0)) *
-            body_get_mass(list_get(aux->bodies, 1)) /
-            vec_dot(displacement, displacement),
-        unit_disp);
-    body_add_force(list_get(aux->bodies, 1), grav_force);
-    body_add_force(list_get(aux->bodies, 0), vec_multiply(-1, grav_force));
+    vector_t grav_force =
+        vec_multiply(G * body_get_mass(body1) * body_get_mass(body2) /
+                         vec_dot(displacement, displacement),
+                     unit_disp);
+    body_add_force(body2, grav_force);
+    body_add_force(body1, vec_multiply(-1, grav_force));
   }
 }
 
+/**
+ * The force creator for gravitational forces between objects. Calculates
+ * the magnitude of the force components and adds the force to each
+ * associated body.
+ *
+ * @param info auxiliary information about the force and associated bodies
+ */
+static void newtonian_gravity(void *info) {
+  body_aux_t *aux = (body_aux_t *)info;
+  apply_newtonian_gravity(aux->force_const, list_get(aux->bodies, 0),
+                          list_get(aux->bodies, 1));
+}
+
 void create_newtonian_gravity(scene_t *scene, double G, body_t *body1,
                               body_t *body2) {
   list_t *bodies = list_init(2, NULL);
@@ -131,6 +169,71 @@ void create_newtonian_gravity(scene_t *scene, double G, body_t *body1,
                                  bodies);
 }
 
+/**
+ * The force creator for gravity between every body in one category and every
+ * body in another. Bodies of the second category are gathered first, so each
+ * tick costs one pass over the scene plus one force per pair.
+ *
+ * @param info auxiliary information about the force and its categories
+ */
+static void category_gravity(void *info) {
+  category_aux_t *aux = info;
+  scene_t *scene = aux->scene;
+
+  while (list_size(aux->bodies) > 0) {
+    list_remove(aux->bodies, list_size(aux->bodies) - 1);
+  }
+  for (size_t i = 0; i < scene_bodies(scene); i++) {
+    body_t *body = scene_get_body(scene, i);
+    if ((body_get_category(body) & aux->category2) && !body_is_removed(body)) {
+      list_add(aux->bodies, body);
+    }
+  }
+  if (list_size(aux->bodies) == 0) {
+    return;
+  }
+
+  // the number of gathered bodies that come before body1 in the scene
+  size_t num_earlier = 0;
+  for (size_t i = 0; i < scene_bodies(scene); i++) {
+    body_t *body1 = scene_get_body(scene, i);
+    if (body_is_removed(body1)) {
+      continue;
+    }
+    uint32_t category = body_get_category(body1);
+    bool in_both = (category & aux->category1) && (category & aux->category2);
+    if (category & aux->category1) {
+      for (size_t j = 0; j < list_size(aux->bodies); j++) {
+        body_t *body2 = list_get(aux->bodies, j);
+        // when the categories overlap, an earlier body in both already
+        // applied the force of this pair
+        if (body1 == body2 ||
+            (in_both && j < num_earlier &&
+             (body_get_category(body2) & aux->category1))) {
+          continue;
+        }
+        apply_newtonian_gravity(aux->force_const, body1, body2);
+      }
+    }
+    if (category & aux->category2) {
+      num_earlier++;
+    }
+  }
+}
+
+void create_category_newtonian_gravity(scene_t *scene, double G,
+                                       uint32_t category1,
+                                       uint32_t category2) {
+  category_aux_t *aux = malloc(sizeof(category_aux_t));
+  assert(aux);
+  aux->force_const = G;
+  aux->bodies = list_init(INITIAL_CATEGORY_BODIES, NULL);
+  aux->category1 = category1;
+  aux->category2 = category2;
+  aux->scene = scene;
+  scene_add_force_creator(scene, category_gravity, aux);
+}
+
 /**
  * The force creator for spring forces between objects. Calculates
  * the magnitude of the force components and adds the force to each
@@ -204,6 +307,12 @@ static void collision_force_creator(void *collision_aux) {
   body_t *body1 = list_get(bodies, 0);
   body_t *body2 = list_get(bodies, 1);
 
+  // Bodies the broadphase didn't pair up can't be touching
+  if (!scene_may_collide(col_aux->scene, body1, body2)) {
+    col_aux->collided = false;
+    return;
+  }
+
   // Check for collision; if bodies collide, call collision_handler
   bool prev_collision = col_aux->collided;
 
@@ -244,9 +353,10 @@ void create_collision(scene_t *scene, body_t *body1, body_t *body2,
   list_add(aux_bodies, body2);
 
   collision_aux_t *collision_aux =
-      collision_aux_init(force_const, aux_bodies, handler, false, aux);
+      collision_aux_init(force_const, aux_bodies, handler, false, aux, scene);
 
-  scene_add_bodies_force_creator(scene, collision_force_creator, collision_aux,
+  // collision handlers can do anything, so they can't run concurrently
+  scene_add_serial_force_creator(scene, collision_force_creator, collision_aux,
                                  bodies);
 }
 
@@ -293,6 +403,13 @@ void create_one_sided_destructive_collision(scene_t *scene, body_t *body1,
                    NULL, 1);
 }
 
+void create_category_one_sided_destructive_collision(scene_t *scene,
+                                                     uint32_t category1,
+                                                     uint32_t category2) {
+  scene_add_collision_rule(scene, category1, category2,
+                           one_sided_destructive_collision_handler, NULL, 1);
+}
+
 void physics_collision_handler(body_t *body1, body_t *body2, vector_t axis,
                                void *aux, double force_const) {
   double m1 = body_get_mass(body1);
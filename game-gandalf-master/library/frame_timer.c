@@ -0,0 +1,95 @@
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef __EMSCRIPTEN__
+#include <emscripten.h>
+#endif
+
+#include "frame_timer.h"
+
+const double NS_PER_MS = 1e6;
+const uint64_t NS_PER_S = 1000000000;
+
+struct frame_stats {
+  // a ring buffer of the latest `count` frame times, oldest at `next` once full
+  double *times;
+  size_t capacity;
+  size_t count;
+  size_t next;
+  // scratch space for sorting, so summarizing doesn't allocate
+  double *sorted;
+};
+
+uint64_t timer_now_ns(void) {
+#ifdef __EMSCRIPTEN__
+  return (uint64_t)(emscripten_get_now() * NS_PER_MS);
+#else
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * NS_PER_S + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+frame_stats_t *frame_stats_init(size_t capacity) {
+  assert(capacity > 0);
+  frame_stats_t *stats = malloc(sizeof(frame_stats_t));
+  assert(stats);
+  stats->times = malloc(sizeof(double) * capacity);
+  stats->sorted = malloc(sizeof(double) * capacity);
+  assert(stats->times && stats->sorted);
+  stats->capacity = capacity;
+  stats->count = 0;
+  stats->next = 0;
+  return stats;
+}
+
+void frame_stats_free(frame_stats_t *stats) {
+  free(stats->times);
+  free(stats->sorted);
+  free(stats);
+}
+
+void frame_stats_add(frame_stats_t *stats, double seconds) {
+  stats->times[stats->next] = seconds;
+  stats->next = (stats->next + 1) % stats->capacity;
+  if (stats->count < stats->capacity) {
+    stats->count++;
+  }
+}
+
+static int compare_doubles(const void *a, const void *b) {
+  double x = *(const double *)a, y = *(const double *)b;
+  return (x > y) - (x < y);
+}
+
+/**
+ * Gets the nearest-rank percentile of some sorted values.
+ */
+static double percentile(const double *sorted, size_t count, double fraction) {
+  size_t rank = (size_t)ceil(fraction * count);
+  return sorted[rank > 0 ? rank - 1 : 0];
+}
+
+frame_summary_t frame_stats_summarize(frame_stats_t *stats) {
+  frame_summary_t summary = {0, 0, 0, 0, 0};
+  size_t count = stats->count;
+  if (count == 0) {
+    return summary;
+  }
+  memcpy(stats->sorted, stats->times, sizeof(double) * count);
+  qsort(stats->sorted, count, sizeof(double), compare_doubles);
+
+  double total = 0;
+  for (size_t i = 0; i < count; i++) {
+    total += stats->sorted[i];
+  }
+  summary.count = count;
+  summary.mean = total / count;
+  summary.p50 = percentile(stats->sorted, count, 0.5);
+  summary.p99 = percentile(stats->sorted, count, 0.99);
+  summary.max = stats->sorted[count - 1];
+  return summary;
+}
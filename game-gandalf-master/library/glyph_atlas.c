@@ -0,0 +1,180 @@
+#include <SDL2/SDL_ttf.h>
+#include <assert.h>
+#include <math.h>
+#include <string.h>
+
+#include "atlas_pack.h"
+#include "glyph_atlas.h"
+#include "list.h"
+#include "sdl_wrapper.h"
+
+// the glyphs in every atlas: printable ASCII
+const char FIRST_GLYPH = ' ';
+const char LAST_GLYPH = '~';
+// glyphs are rasterized in white and tinted when drawn
+const SDL_Color GLYPH_COLOR = {255, 255, 255, 255};
+const size_t INITIAL_NUM_ATLASES = 1;
+const size_t INITIAL_NUM_QUADS = 16;
+
+typedef struct glyph {
+  bool provided;
+  // where the glyph is in the texture, empty if the glyph is blank
+  SDL_Rect cell;
+  // how far the glyph moves the pen to the right
+  int advance;
+} glyph_t;
+
+struct glyph_atlas {
+  TTF_Font *font;
+  SDL_Texture *texture;
+  // the line height of the font, which a drawn string is stretched over
+  int height;
+  // indexed by character - FIRST_GLYPH
+  glyph_t *glyphs;
+  // the quads of the last string drawn, grown to fit the longest string
+  SDL_Rect *src;
+  SDL_Rect *dst;
+  size_t quad_capacity;
+};
+
+static list_t *ATLASES;
+
+static glyph_t *glyph_atlas_find(glyph_atlas_t *atlas, char c) {
+  if (c < FIRST_GLYPH || c > LAST_GLYPH) {
+    return NULL;
+  }
+  glyph_t *glyph = &atlas->glyphs[c - FIRST_GLYPH];
+  return glyph->provided ? glyph : NULL;
+}
+
+/**
+ * Rasterizes each glyph of a font and packs them into one texture.
+ */
+static glyph_atlas_t *glyph_atlas_init(TTF_Font *font) {
+  size_t num_glyphs = LAST_GLYPH - FIRST_GLYPH + 1;
+  glyph_atlas_t *atlas = malloc(sizeof(glyph_atlas_t));
+  assert(atlas);
+  atlas->font = font;
+  atlas->height = TTF_FontHeight(font);
+  atlas->glyphs = calloc(num_glyphs, sizeof(glyph_t));
+  SDL_Surface **surfaces = calloc(num_glyphs, sizeof(SDL_Surface *));
+  sprite_t *cells = malloc(sizeof(sprite_t) * num_glyphs);
+  assert(atlas->glyphs && surfaces && cells);
+
+  for (size_t i = 0; i < num_glyphs; i++) {
+    uint16_t c = FIRST_GLYPH + i;
+    glyph_t *glyph = &atlas->glyphs[i];
+    int min_x, max_x, min_y, max_y;
+    if (!TTF_GlyphIsProvided(font, c) ||
+        TTF_GlyphMetrics(font, c, &min_x, &max_x, &min_y, &max_y,
+                         &glyph->advance) != 0) {
+      continue;
+    }
+    glyph->provided = true;
+    surfaces[i] = TTF_RenderGlyph_Blended(font, c, GLYPH_COLOR);
+  }
+
+  size_t num_pages;
+  SDL_Texture **pages =
+      atlas_pack_images(surfaces, num_glyphs, cells, &num_pages);
+  // a font's printable ASCII glyphs are far smaller than a page
+  assert(num_pages <= 1);
+  atlas->texture = num_pages == 1 ? pages[0] : NULL;
+  for (size_t i = 0; i < num_glyphs; i++) {
+    atlas->glyphs[i].cell = cells[i].region;
+  }
+  free(pages);
+  free(cells);
+  free(surfaces);
+
+  atlas->quad_capacity = INITIAL_NUM_QUADS;
+  atlas->src = malloc(sizeof(SDL_Rect) * atlas->quad_capacity);
+  atlas->dst = malloc(sizeof(SDL_Rect) * atlas->quad_capacity);
+  assert(atlas->src && atlas->dst);
+  return atlas;
+}
+
+static void glyph_atlas_free(glyph_atlas_t *atlas) {
+  if (atlas == NULL) {
+    return;
+  }
+  sdl_destroy_texture(atlas->texture);
+  free(atlas->glyphs);
+  free(atlas->src);
+  free(atlas->dst);
+  free(atlas);
+}
+
+glyph_atlas_t *glyph_atlas_get(TTF_Font *font) {
+  if (font == NULL) {
+    return NULL;
+  }
+  if (ATLASES == NULL) {
+    ATLASES = list_init(INITIAL_NUM_ATLASES, (free_func_t)glyph_atlas_free);
+  }
+  // a game has a handful of fonts at most
+  for (size_t i = 0; i < list_size(ATLASES); i++) {
+    glyph_atlas_t *atlas = list_get(ATLASES, i);
+    if (atlas->font == font) {
+      return atlas;
+    }
+  }
+  glyph_atlas_t *atlas = glyph_atlas_init(font);
+  list_add(ATLASES, atlas);
+  return atlas;
+}
+
+bool glyph_atlas_draw_text(glyph_atlas_t *atlas, const char *text,
+                           SDL_Rect box, rgb_color_t color) {
+  size_t length = strlen(text);
+  int width = 0;
+  for (size_t i = 0; i < length; i++) {
+    glyph_t *glyph = glyph_atlas_find(atlas, text[i]);
+    if (glyph == NULL) {
+      return false;
+    }
+    width += glyph->advance;
+  }
+  if (width <= 0) {
+    return true;
+  }
+
+  if (length > atlas->quad_capacity) {
+    while (atlas->quad_capacity < length) {
+      atlas->quad_capacity *= 2;
+    }
+    atlas->src = realloc(atlas->src, sizeof(SDL_Rect) * atlas->quad_capacity);
+    atlas->dst = realloc(atlas->dst, sizeof(SDL_Rect) * atlas->quad_capacity);
+    assert(atlas->src && atlas->dst);
+  }
+
+  // stretch the string's natural size over the box, rounding each glyph's
+  // edges rather than its width so that no gaps open between glyphs
+  double scale_x = (double)box.w / width;
+  double scale_y = (double)box.h / atlas->height;
+  size_t num_quads = 0;
+  int pen = 0;
+  for (size_t i = 0; i < length; i++) {
+    glyph_t *glyph = glyph_atlas_find(atlas, text[i]);
+    SDL_Rect cell = glyph->cell;
+    if (cell.w > 0) {
+      int left = lround(pen * scale_x);
+      int right = lround((pen + cell.w) * scale_x);
+      atlas->src[num_quads] = cell;
+      atlas->dst[num_quads] = (SDL_Rect){box.x + left, box.y, right - left,
+                                         lround(cell.h * scale_y)};
+      num_quads++;
+    }
+    pen += glyph->advance;
+  }
+  sdl_render_texture_regions(atlas->texture, atlas->src, atlas->dst,
+                             num_quads, color);
+  return true;
+}
+
+void glyph_atlas_destroy_all() {
+  if (ATLASES != NULL) {
+    list_free(ATLASES);
+    ATLASES = NULL;
+  }
+}
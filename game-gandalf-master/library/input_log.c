@@ -0,0 +1,255 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "input_log.h"
+
+const char INPUT_LOG_MAGIC[4] = {'A', '5', 'R', 'P'};
+const uint16_t INPUT_LOG_VERSION = 1;
+const size_t INPUT_LOG_HEADER_SIZE = 16;
+const uint8_t FRAME_RECORD = 'F';
+const uint8_t KEYFRAME_RECORD = 'K';
+const uint8_t FRAME_CLICKED = 1 << 0;
+const size_t INITIAL_NUM_FRAMES = 1024;
+const size_t INITIAL_FILE_SIZE = 4096;
+
+struct input_log {
+  uint32_t seed;
+  uint32_t keyframe_interval;
+
+  // while recording: the file being written, otherwise NULL
+  FILE *file;
+
+  // once loaded: every frame, and the keyframes indexed by
+  // frame / keyframe_interval, with `has_keyframe` marking the ones recorded
+  input_frame_t *frames;
+  size_t num_frames;
+  keyframe_t *keyframes;
+  bool *has_keyframe;
+  size_t num_keyframe_slots;
+};
+
+static void put_u16(uint8_t *bytes, uint16_t value) {
+  bytes[0] = value;
+  bytes[1] = value >> 8;
+}
+
+static void put_u32(uint8_t *bytes, uint32_t value) {
+  put_u16(bytes, value);
+  put_u16(bytes + 2, value >> 16);
+}
+
+static void put_u64(uint8_t *bytes, uint64_t value) {
+  put_u32(bytes, value);
+  put_u32(bytes + 4, value >> 32);
+}
+
+static uint16_t get_u16(const uint8_t *bytes) {
+  return bytes[0] | (uint16_t)bytes[1] << 8;
+}
+
+static uint32_t get_u32(const uint8_t *bytes) {
+  return get_u16(bytes) | (uint32_t)get_u16(bytes + 2) << 16;
+}
+
+static uint64_t get_u64(const uint8_t *bytes) {
+  return get_u32(bytes) | (uint64_t)get_u32(bytes + 4) << 32;
+}
+
+static input_log_t *input_log_init(uint32_t seed, uint32_t keyframe_interval) {
+  assert(keyframe_interval > 0);
+  input_log_t *log = malloc(sizeof(input_log_t));
+  assert(log);
+  log->seed = seed;
+  log->keyframe_interval = keyframe_interval;
+  log->file = NULL;
+  log->frames = NULL;
+  log->num_frames = 0;
+  log->keyframes = NULL;
+  log->has_keyframe = NULL;
+  log->num_keyframe_slots = 0;
+  return log;
+}
+
+input_log_t *input_log_record(const char *path, uint32_t seed,
+                              uint32_t keyframe_interval) {
+  FILE *file = fopen(path, "wb");
+  if (file == NULL) {
+    return NULL;
+  }
+  input_log_t *log = input_log_init(seed, keyframe_interval);
+  log->file = file;
+
+  uint8_t header[INPUT_LOG_HEADER_SIZE];
+  memcpy(header, INPUT_LOG_MAGIC, sizeof(INPUT_LOG_MAGIC));
+  put_u16(header + 4, INPUT_LOG_VERSION);
+  put_u16(header + 6, 0);
+  put_u32(header + 8, seed);
+  put_u32(header + 12, keyframe_interval);
+  fwrite(header, 1, INPUT_LOG_HEADER_SIZE, file);
+  return log;
+}
+
+void input_log_add_frame(input_log_t *log, input_frame_t frame) {
+  assert(log->file);
+  uint8_t record[12];
+  size_t size = 8;
+  record[0] = FRAME_RECORD;
+  put_u32(record + 1, frame.dt_ns);
+  put_u16(record + 5, frame.keys);
+  record[7] = frame.clicked ? FRAME_CLICKED : 0;
+  if (frame.clicked) {
+    put_u16(record + 8, frame.click_x);
+    put_u16(record + 10, frame.click_y);
+    size = 12;
+  }
+  fwrite(record, 1, size, log->file);
+  log->num_frames++;
+}
+
+void input_log_add_keyframe(input_log_t *log, keyframe_t keyframe) {
+  assert(log->file);
+  uint8_t record[17];
+  record[0] = KEYFRAME_RECORD;
+  put_u32(record + 1, keyframe.frame);
+  put_u32(record + 5, keyframe.num_bodies);
+  put_u64(record + 9, keyframe.digest);
+  fwrite(record, 1, sizeof(record), log->file);
+  // a killed or crashed game loses at most the frames since the last keyframe
+  fflush(log->file);
+}
+
+/**
+ * Reads a whole file into memory.
+ * Returns NULL if it can't be read, otherwise stores its size in `size`.
+ */
+static uint8_t *read_file(const char *path, size_t *size) {
+  FILE *file = fopen(path, "rb");
+  if (file == NULL) {
+    return NULL;
+  }
+  size_t capacity = INITIAL_FILE_SIZE;
+  uint8_t *bytes = malloc(capacity);
+  assert(bytes);
+  *size = 0;
+  size_t read;
+  while ((read = fread(bytes + *size, 1, capacity - *size, file)) > 0) {
+    *size += read;
+    if (*size == capacity) {
+      capacity *= 2;
+      bytes = realloc(bytes, capacity);
+      assert(bytes);
+    }
+  }
+  fclose(file);
+  return bytes;
+}
+
+/**
+ * Stores a keyframe in its slot, growing the slots to fit.
+ */
+static void input_log_set_keyframe(input_log_t *log, keyframe_t keyframe) {
+  size_t slot = keyframe.frame / log->keyframe_interval;
+  if (slot >= log->num_keyframe_slots) {
+    size_t num_slots = log->num_keyframe_slots ? log->num_keyframe_slots : 1;
+    while (num_slots <= slot) {
+      num_slots *= 2;
+    }
+    log->keyframes = realloc(log->keyframes, sizeof(keyframe_t) * num_slots);
+    log->has_keyframe = realloc(log->has_keyframe, sizeof(bool) * num_slots);
+    assert(log->keyframes && log->has_keyframe);
+    for (size_t i = log->num_keyframe_slots; i < num_slots; i++) {
+      log->has_keyframe[i] = false;
+    }
+    log->num_keyframe_slots = num_slots;
+  }
+  log->keyframes[slot] = keyframe;
+  log->has_keyframe[slot] = true;
+}
+
+input_log_t *input_log_load(const char *path) {
+  size_t size;
+  uint8_t *bytes = read_file(path, &size);
+  if (bytes == NULL) {
+    return NULL;
+  }
+  if (size < INPUT_LOG_HEADER_SIZE ||
+      memcmp(bytes, INPUT_LOG_MAGIC, sizeof(INPUT_LOG_MAGIC)) != 0 ||
+      get_u16(bytes + 4) != INPUT_LOG_VERSION || get_u32(bytes + 12) == 0) {
+    free(bytes);
+    return NULL;
+  }
+  input_log_t *log = input_log_init(get_u32(bytes + 8), get_u32(bytes + 12));
+
+  size_t capacity = INITIAL_NUM_FRAMES;
+  log->frames = malloc(sizeof(input_frame_t) * capacity);
+  assert(log->frames);
+  size_t offset = INPUT_LOG_HEADER_SIZE;
+  // a truncated last record, e.g. from a crash, is ignored
+  while (offset < size) {
+    const uint8_t *record = bytes + offset;
+    if (record[0] == FRAME_RECORD && offset + 8 <= size) {
+      input_frame_t frame = {get_u32(record + 1), get_u16(record + 5),
+                             record[7] & FRAME_CLICKED, 0, 0};
+      if (frame.clicked) {
+        if (offset + 12 > size) {
+          break;
+        }
+        frame.click_x = get_u16(record + 8);
+        frame.click_y = get_u16(record + 10);
+        offset += 4;
+      }
+      if (log->num_frames == capacity) {
+        capacity *= 2;
+        log->frames = realloc(log->frames, sizeof(input_frame_t) * capacity);
+        assert(log->frames);
+      }
+      log->frames[log->num_frames++] = frame;
+      offset += 8;
+    } else if (record[0] == KEYFRAME_RECORD && offset + 17 <= size) {
+      keyframe_t keyframe = {get_u32(record + 1), get_u32(record + 5),
+                             get_u64(record + 9)};
+      input_log_set_keyframe(log, keyframe);
+      offset += 17;
+    } else {
+      break;
+    }
+  }
+  free(bytes);
+  return log;
+}
+
+void input_log_free(input_log_t *log) {
+  if (log->file != NULL) {
+    fclose(log->file);
+  }
+  free(log->frames);
+  free(log->keyframes);
+  free(log->has_keyframe);
+  free(log);
+}
+
+uint32_t input_log_get_seed(input_log_t *log) { return log->seed; }
+
+uint32_t input_log_get_keyframe_interval(input_log_t *log) {
+  return log->keyframe_interval;
+}
+
+size_t input_log_num_frames(input_log_t *log) { return log->num_frames; }
+
+input_frame_t input_log_get_frame(input_log_t *log, size_t index) {
+  assert(index < log->num_frames);
+  return log->frames[index];
+}
+
+bool input_log_get_keyframe(input_log_t *log, size_t frame,
+                            keyframe_t *keyframe) {
+  size_t slot = frame / log->keyframe_interval;
+  if (frame % log->keyframe_interval != 0 ||
+      slot >= log->num_keyframe_slots || !log->has_keyframe[slot]) {
+    return false;
+  }
+  *keyframe = log->keyframes[slot];
+  return true;
+}
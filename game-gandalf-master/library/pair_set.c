@@ -0,0 +1,97 @@
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "pair_set.h"
+
+const size_t PAIR_SET_INITIAL_CAPACITY = 128;
+
+struct pair_set {
+  body_pair_t *slots; // open addressing, empty slots have body1 == NULL
+  size_t size;
+  size_t capacity; // always a power of 2
+};
+
+pair_set_t *pair_set_init(void) {
+  pair_set_t *set = malloc(sizeof(pair_set_t));
+  assert(set);
+  set->slots = calloc(PAIR_SET_INITIAL_CAPACITY, sizeof(body_pair_t));
+  assert(set->slots);
+  set->size = 0;
+  set->capacity = PAIR_SET_INITIAL_CAPACITY;
+  return set;
+}
+
+void pair_set_free(pair_set_t *set) {
+  free(set->slots);
+  free(set);
+}
+
+void pair_set_clear(pair_set_t *set) {
+  for (size_t i = 0; i < set->capacity; i++) {
+    set->slots[i] = (body_pair_t){NULL, NULL};
+  }
+  set->size = 0;
+}
+
+/** Orders the two bodies of a pair so lookups don't depend on argument order */
+static body_pair_t make_key(body_t *body1, body_t *body2) {
+  if ((uintptr_t)body1 > (uintptr_t)body2) {
+    return (body_pair_t){body2, body1};
+  }
+  return (body_pair_t){body1, body2};
+}
+
+static size_t home_slot(pair_set_t *set, body_pair_t key) {
+  uint64_t h = (uint64_t)(uintptr_t)key.body1 * 0x9E3779B97F4A7C15ULL;
+  h ^= (uint64_t)(uintptr_t)key.body2 + 0x7F4A7C159E3779B9ULL + (h << 6) +
+       (h >> 2);
+  return (size_t)(h ^ (h >> 31)) & (set->capacity - 1);
+}
+
+/**
+ * Finds the slot holding `key`, or the empty slot where it would be inserted.
+ */
+static size_t find_slot(pair_set_t *set, body_pair_t key) {
+  size_t slot = home_slot(set, key);
+  while (set->slots[slot].body1 != NULL &&
+         (set->slots[slot].body1 != key.body1 ||
+          set->slots[slot].body2 != key.body2)) {
+    slot = (slot + 1) & (set->capacity - 1);
+  }
+  return slot;
+}
+
+/** Doubles the capacity of the set and reinserts every pair */
+static void pair_set_resize(pair_set_t *set) {
+  body_pair_t *old_slots = set->slots;
+  size_t old_capacity = set->capacity;
+  set->capacity *= 2;
+  set->slots = calloc(set->capacity, sizeof(body_pair_t));
+  assert(set->slots);
+  for (size_t i = 0; i < old_capacity; i++) {
+    if (old_slots[i].body1 != NULL) {
+      set->slots[find_slot(set, old_slots[i])] = old_slots[i];
+    }
+  }
+  free(old_slots);
+}
+
+void pair_set_add(pair_set_t *set, body_t *body1, body_t *body2) {
+  assert(body1 && body2);
+  // keep the load factor at or below 1/2 so probe sequences stay short
+  if (2 * (set->size + 1) > set->capacity) {
+    pair_set_resize(set);
+  }
+  body_pair_t key = make_key(body1, body2);
+  size_t slot = find_slot(set, key);
+  if (set->slots[slot].body1 == NULL) {
+    set->slots[slot] = key;
+    set->size++;
+  }
+}
+
+bool pair_set_contains(pair_set_t *set, body_t *body1, body_t *body2) {
+  body_pair_t key = make_key(body1, body2);
+  return set->slots[find_slot(set, key)].body1 != NULL;
+}
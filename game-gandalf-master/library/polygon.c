@@ -1,5 +1,6 @@
 #include <assert.h>
 #include <math.h>
+#include <stdbool.h>
 #include <stdlib.h>
 
 #include "polygon.h"
@@ -7,31 +8,146 @@
 const vector_t GRAVITY = (vector_t){.x = 0.0, .y = -10.0};
 
 struct polygon {
-  list_t *vertex_list;
-  vector_t velocity;
+  shape_t *shape;
+  bool owns_shape;
+
+  // transform from the shape's local space to the scene
   vector_t centroid;
+  double angle;
+
+  vector_t velocity;
   double rotation_speed;
   rgb_color_t *color;
+
+  // bounding box relative to the centroid, valid while `angle == bounds_angle`
+  vector_t local_min;
+  vector_t local_max;
+  double bounds_angle;
+
+  // scene vertices, allocated on first use and valid while the transform
+  // matches the one they were computed for.
+  // `world_list` views the same memory for polygon_get_points().
+  vector_t *world_vertices;
+  list_t *world_list;
+  vector_t world_centroid;
+  double world_angle;
 };
 
 polygon_t *polygon_init(list_t *points, vector_t initial_velocity,
                         double rotation_speed, double red, double green,
                         double blue) {
+  shape_t *shape = shape_init(points);
+  list_free(points);
+  // the given vertices are the scene vertices for the initial transform
+  polygon_t *polygon = polygon_init_with_shape(
+      shape, shape_get_centroid_offset(shape), initial_velocity, rotation_speed,
+      red, green, blue);
+  polygon->owns_shape = true;
+  return polygon;
+}
+
+polygon_t *polygon_init_with_shape(shape_t *shape, vector_t centroid,
+                                   vector_t initial_velocity,
+                                   double rotation_speed, double red,
+                                   double green, double blue) {
   polygon_t *polygon = malloc(sizeof(polygon_t));
   assert(polygon);
-  polygon->vertex_list = points;
+  polygon->shape = shape;
+  polygon->owns_shape = false;
+  polygon->centroid = centroid;
+  polygon->angle = 0;
   polygon->velocity = initial_velocity;
   polygon->rotation_speed = rotation_speed;
   polygon->color = color_init(red, green, blue);
-  polygon->centroid = polygon_centroid(polygon);
+  // forces the bounding box to be computed on first use
+  polygon->bounds_angle = NAN;
+  polygon->world_vertices = NULL;
+  polygon->world_list = NULL;
   return polygon;
 }
 
+/**
+ * Recomputes the scene vertices if the polygon moved since they were
+ * last computed.
+ *
+ * @param polygon the polygon to update
+ */
+static void polygon_update_world(polygon_t *polygon) {
+  size_t size = shape_num_vertices(polygon->shape);
+  if (polygon->world_vertices == NULL) {
+    polygon->world_vertices = malloc(sizeof(vector_t) * size);
+    assert(polygon->world_vertices);
+  } else if (polygon->world_angle == polygon->angle &&
+             polygon->world_centroid.x == polygon->centroid.x &&
+             polygon->world_centroid.y == polygon->centroid.y) {
+    return;
+  }
+  const vector_t *local_vertices = shape_get_vertices(polygon->shape);
+  double c = cos(polygon->angle), s = sin(polygon->angle);
+  for (size_t i = 0; i < size; i++) {
+    vector_t local = local_vertices[i];
+    polygon->world_vertices[i] =
+        (vector_t){polygon->centroid.x + local.x * c - local.y * s,
+                   polygon->centroid.y + local.x * s + local.y * c};
+  }
+  polygon->world_centroid = polygon->centroid;
+  polygon->world_angle = polygon->angle;
+}
+
+/**
+ * Recomputes the bounding box relative to the centroid
+ * if the polygon rotated since it was last computed.
+ * Translations don't invalidate it.
+ *
+ * @param polygon the polygon to update
+ */
+static void polygon_update_bounds(polygon_t *polygon) {
+  if (polygon->bounds_angle == polygon->angle) {
+    return;
+  }
+  const vector_t *local_vertices = shape_get_vertices(polygon->shape);
+  double c = cos(polygon->angle), s = sin(polygon->angle);
+  vector_t min = {__DBL_MAX__, __DBL_MAX__};
+  vector_t max = {-__DBL_MAX__, -__DBL_MAX__};
+  for (size_t i = 0; i < shape_num_vertices(polygon->shape); i++) {
+    vector_t local = local_vertices[i];
+    vector_t rotated = {local.x * c - local.y * s, local.x * s + local.y * c};
+    min.x = fmin(min.x, rotated.x);
+    min.y = fmin(min.y, rotated.y);
+    max.x = fmax(max.x, rotated.x);
+    max.y = fmax(max.y, rotated.y);
+  }
+  polygon->local_min = min;
+  polygon->local_max = max;
+  polygon->bounds_angle = polygon->angle;
+}
+
 list_t *polygon_get_points(polygon_t *polygon) {
   assert(polygon);
-  return polygon->vertex_list;
+  polygon_update_world(polygon);
+  if (polygon->world_list == NULL) {
+    size_t size = shape_num_vertices(polygon->shape);
+    polygon->world_list = list_init(size, NULL);
+    for (size_t i = 0; i < size; i++) {
+      list_add(polygon->world_list, &polygon->world_vertices[i]);
+    }
+  }
+  return polygon->world_list;
+}
+
+const vector_t *polygon_get_vertices(polygon_t *polygon) {
+  polygon_update_world(polygon);
+  return polygon->world_vertices;
+}
+
+size_t polygon_num_vertices(polygon_t *polygon) {
+  return shape_num_vertices(polygon->shape);
 }
 
+shape_t *polygon_get_shape(polygon_t *polygon) { return polygon->shape; }
+
+double polygon_get_angle(polygon_t *polygon) { return polygon->angle; }
+
 void polygon_move(polygon_t *polygon, double time_elapsed) {
   vector_t old_vel = polygon->velocity;
   vector_t translation = vec_multiply(time_elapsed, old_vel);
@@ -51,7 +167,13 @@ void polygon_set_velocity(polygon_t *polygon, vector_t vel) {
 }
 
 void polygon_free(polygon_t *polygon) {
-  list_free(polygon->vertex_list);
+  if (polygon->world_list != NULL) {
+    list_free(polygon->world_list);
+  }
+  free(polygon->world_vertices);
+  if (polygon->owns_shape) {
+    shape_free(polygon->shape);
+  }
   color_free(polygon->color);
   free(polygon);
 }
@@ -59,75 +181,34 @@ void polygon_free(polygon_t *polygon) {
 vector_t polygon_get_velocity(polygon_t *polygon) { return polygon->velocity; }
 
 double polygon_area(polygon_t *polygon) {
-  list_t *vertex_list = polygon->vertex_list;
-  double sum = 0.0;
-  size_t size = list_size(vertex_list);
-  // Shoelace Theorem
-  for (size_t i = 0; i < size; i++) {
-    vector_t *vec_i = list_get(vertex_list, i);
-    vector_t *vec_i_plus = list_get(vertex_list, (i + 1) % size);
-
-    double x_i = vec_i->x;
-    double y_i = vec_i->y;
-    double x_i_plus = vec_i_plus->x;
-    double y_i_plus = vec_i_plus->y;
-
-    sum += (x_i_plus + x_i) * (y_i_plus - y_i);
-  }
-  return 0.5 * (fabs(sum));
+  return shape_get_area(polygon->shape);
 }
 
-vector_t polygon_centroid(polygon_t *polygon) {
-  list_t *vertex_list = polygon->vertex_list;
-  vector_t centroid = VEC_ZERO;
-  double area = polygon_area(polygon);
-  size_t size = list_size(vertex_list);
-
-  for (size_t i = 0; i < size; i++) {
-    vector_t *vec_i = list_get(vertex_list, i);
-    vector_t *vec_i_plus = list_get(vertex_list, (i + 1) % size);
-
-    double x_i = vec_i->x;
-    double x_i_plus = vec_i_plus->x;
-    double y_i = vec_i->y;
-    double y_i_plus = vec_i_plus->y;
-
-    // (x_i + x_{i+1})(x_i * y_{i+1} - x_{i+1} * y_i)
-    centroid.x += (x_i + x_i_plus) * (x_i * y_i_plus - y_i * x_i_plus);
-    // (y_i + y_{i+1})(x_i * y_{i+1} - x_{i+1} * y_i)
-    centroid.y += (y_i + y_i_plus) * (x_i * y_i_plus - y_i * x_i_plus);
-  }
-  centroid.x /= (6 * area);
-  centroid.y /= (6 * area);
-  polygon->centroid = centroid;
-  return centroid;
-}
+vector_t polygon_centroid(polygon_t *polygon) { return polygon->centroid; }
 
 void polygon_translate(polygon_t *polygon, vector_t translation) {
-  list_t *vertex_list = polygon->vertex_list;
-  size_t size = list_size(vertex_list);
-  for (size_t i = 0; i < size; i++) {
-    vector_t *vec_i = list_get(vertex_list, i);
-    vec_i->x += translation.x;
-    vec_i->y += translation.y;
-  }
-  polygon->centroid = polygon_centroid(polygon);
+  polygon->centroid = vec_add(polygon->centroid, translation);
 }
 
 void polygon_rotate(polygon_t *polygon, double angle, vector_t point) {
-  list_t *vertex_list = polygon->vertex_list;
-  size_t size = list_size(vertex_list);
-  for (size_t i = 0; i < size; i++) {
-    vector_t v_rotate = VEC_ZERO;
-    vector_t *vec_i = list_get(vertex_list, i);
+  polygon->angle += angle;
+  // the centroid moves if it isn't the point being rotated around
+  polygon->centroid = vec_add(
+      point, vec_rotate(vec_subtract(polygon->centroid, point), angle));
+}
 
-    v_rotate.x += vec_i->x - point.x;
-    v_rotate.y += vec_i->y - point.y;
-    v_rotate = vec_rotate(v_rotate, angle);
+vector_t polygon_get_bounds_min(polygon_t *polygon) {
+  polygon_update_bounds(polygon);
+  return vec_add(polygon->centroid, polygon->local_min);
+}
 
-    vec_i->x = v_rotate.x + point.x;
-    vec_i->y = v_rotate.y + point.y;
-  }
+vector_t polygon_get_bounds_max(polygon_t *polygon) {
+  polygon_update_bounds(polygon);
+  return vec_add(polygon->centroid, polygon->local_max);
+}
+
+double polygon_get_radius(polygon_t *polygon) {
+  return shape_get_radius(polygon->shape);
 }
 
 rgb_color_t *polygon_get_color(polygon_t *polygon) { return polygon->color; }
@@ -148,4 +229,4 @@ void polygon_set_rotation(polygon_t *polygon, double rot) {
 
 double polygon_get_rotation(polygon_t *polygon) {
   return polygon->rotation_speed;
-}
\ No newline at end of file
+}
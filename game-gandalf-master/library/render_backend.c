@@ -0,0 +1,308 @@
+#include <SDL2/SDL_image.h>
+#include <SDL2/SDL_mixer.h>
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+
+#include "render_backend.h"
+
+const size_t INITIAL_QUAD_CAPACITY = 64;
+
+/**
+ * The SDL window where the scene is rendered.
+ */
+static SDL_Window *window;
+/**
+ * The renderer used to draw the scene.
+ */
+static SDL_Renderer *renderer;
+/**
+ * The vertices and triangles of the quads being drawn, 4 vertices and
+ * 6 indices per quad, grown to fit the largest batch.
+ */
+static SDL_Vertex *quad_vertices;
+static int *quad_indices;
+static size_t quad_capacity;
+
+/**
+ * The output size of the null backend, as passed to its init().
+ */
+static int null_width;
+static int null_height;
+static render_counts_t null_counts;
+
+static void sdl_backend_init(const char *title, int width, int height) {
+  SDL_Init(SDL_INIT_AUDIO);
+  SDL_Init(SDL_INIT_EVERYTHING);
+  window = SDL_CreateWindow(title, SDL_WINDOWPOS_CENTERED,
+                            SDL_WINDOWPOS_CENTERED, width, height,
+                            SDL_WINDOW_RESIZABLE);
+  renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_PRESENTVSYNC);
+  TTF_Init();
+  Mix_Init(MIX_INIT_OGG || MIX_INIT_WAVPACK);
+  Mix_OpenAudio(44100, MIX_DEFAULT_FORMAT, 2, 2048);
+}
+
+static void sdl_backend_get_output_size(int *width, int *height) {
+  SDL_GetWindowSize(window, width, height);
+}
+
+static void sdl_backend_clear(SDL_Color color) {
+  SDL_SetRenderDrawColor(renderer, color.r, color.g, color.b, 255);
+  SDL_RenderClear(renderer);
+}
+
+static void sdl_backend_draw_triangles(const SDL_Vertex *vertices,
+                                       size_t num_vertices, const int *indices,
+                                       size_t num_indices) {
+  SDL_RenderGeometry(renderer, NULL, vertices, num_vertices, indices,
+                     num_indices);
+}
+
+static void sdl_backend_draw_rect(SDL_Rect rect, SDL_Color color) {
+  SDL_SetRenderDrawColor(renderer, color.r, color.g, color.b, 255);
+  SDL_RenderDrawRect(renderer, &rect);
+}
+
+static void sdl_backend_present(void) { SDL_RenderPresent(renderer); }
+
+static SDL_Texture *sdl_backend_load_img_texture(const char *path) {
+  return IMG_LoadTexture(renderer, path);
+}
+
+static SDL_Surface *sdl_backend_load_img_surface(const char *path) {
+  return IMG_Load(path);
+}
+
+static SDL_Texture *sdl_backend_load_text_texture(TTF_Font *font,
+                                                  const char *msg,
+                                                  SDL_Color color) {
+  SDL_Surface *message = TTF_RenderText_Blended(font, msg, color);
+  assert(message);
+  SDL_Texture *texture = SDL_CreateTextureFromSurface(renderer, message);
+  SDL_FreeSurface(message);
+  return texture;
+}
+
+static SDL_Texture *sdl_backend_load_surface_texture(SDL_Surface *surface) {
+  return SDL_CreateTextureFromSurface(renderer, surface);
+}
+
+static void sdl_backend_destroy_texture(SDL_Texture *texture) {
+  if (texture != NULL) {
+    SDL_DestroyTexture(texture);
+  }
+}
+
+static void sdl_backend_render_texture(SDL_Texture *texture,
+                                       const SDL_Rect *src, SDL_Rect box,
+                                       double angle) {
+  if (angle == 0) {
+    SDL_RenderCopy(renderer, texture, src, &box);
+    return;
+  }
+  SDL_RenderCopyEx(renderer, texture, src, &box, 180 * angle / M_PI, NULL,
+                   SDL_FLIP_NONE);
+}
+
+/**
+ * Makes room for n quads in quad_vertices and quad_indices.
+ */
+static void reserve_quads(size_t n) {
+  if (n <= quad_capacity) {
+    return;
+  }
+  size_t capacity = quad_capacity ? quad_capacity : INITIAL_QUAD_CAPACITY;
+  while (capacity < n) {
+    capacity *= 2;
+  }
+  quad_vertices = realloc(quad_vertices, sizeof(SDL_Vertex) * 4 * capacity);
+  quad_indices = realloc(quad_indices, sizeof(int) * 6 * capacity);
+  assert(quad_vertices && quad_indices);
+  // every quad is the same two triangles of its 4 vertices
+  for (size_t i = quad_capacity; i < capacity; i++) {
+    int first = 4 * i;
+    int *indices = &quad_indices[6 * i];
+    indices[0] = first;
+    indices[1] = first + 1;
+    indices[2] = first + 2;
+    indices[3] = first;
+    indices[4] = first + 2;
+    indices[5] = first + 3;
+  }
+  quad_capacity = capacity;
+}
+
+/**
+ * Writes the 4 vertices of a quad, clockwise from the top left corner,
+ * with texture coordinates normalized by the texture's size.
+ */
+static void set_quad(size_t i, SDL_Rect src, SDL_Rect dst, double angle,
+                     int width, int height, SDL_Color color) {
+  float u0 = (float)src.x / width, u1 = (float)(src.x + src.w) / width;
+  float v0 = (float)src.y / height, v1 = (float)(src.y + src.h) / height;
+  float us[4] = {u0, u1, u1, u0};
+  float vs[4] = {v0, v0, v1, v1};
+  double half_w = dst.w / 2.0, half_h = dst.h / 2.0;
+  double dxs[4] = {-half_w, half_w, half_w, -half_w};
+  double dys[4] = {-half_h, -half_h, half_h, half_h};
+  double cx = dst.x + half_w, cy = dst.y + half_h;
+  // with y pointing down, this rotates clockwise on screen
+  double c = cos(angle), s = sin(angle);
+  SDL_Vertex *vertices = &quad_vertices[4 * i];
+  for (size_t k = 0; k < 4; k++) {
+    vertices[k].position = (SDL_FPoint){cx + dxs[k] * c - dys[k] * s,
+                                        cy + dxs[k] * s + dys[k] * c};
+    vertices[k].color = color;
+    vertices[k].tex_coord = (SDL_FPoint){us[k], vs[k]};
+  }
+}
+
+static void sdl_backend_render_texture_regions(SDL_Texture *texture,
+                                               const SDL_Rect *src,
+                                               const SDL_Rect *dst, size_t n,
+                                               SDL_Color color) {
+  int width, height;
+  if (texture == NULL || n == 0 ||
+      SDL_QueryTexture(texture, NULL, NULL, &width, &height) != 0) {
+    return;
+  }
+  reserve_quads(n);
+  color.a = 255;
+  for (size_t i = 0; i < n; i++) {
+    set_quad(i, src[i], dst[i], 0, width, height, color);
+  }
+  SDL_RenderGeometry(renderer, texture, quad_vertices, 4 * n, quad_indices,
+                     6 * n);
+}
+
+static void sdl_backend_render_sprites(SDL_Texture *texture,
+                                       const sprite_quad_t *quads, size_t n) {
+  int width, height;
+  // SDL_RenderCopy() draws nothing without a texture, so neither do sprites
+  if (texture == NULL || n == 0 ||
+      SDL_QueryTexture(texture, NULL, NULL, &width, &height) != 0) {
+    return;
+  }
+  reserve_quads(n);
+  SDL_Color white = {255, 255, 255, 255};
+  for (size_t i = 0; i < n; i++) {
+    set_quad(i, quads[i].src, quads[i].dst, quads[i].angle, width, height,
+             white);
+  }
+  SDL_RenderGeometry(renderer, texture, quad_vertices, 4 * n, quad_indices,
+                     6 * n);
+}
+
+const render_backend_t RENDER_BACKEND_SDL = {
+    .init = sdl_backend_init,
+    .get_output_size = sdl_backend_get_output_size,
+    .clear = sdl_backend_clear,
+    .draw_triangles = sdl_backend_draw_triangles,
+    .draw_rect = sdl_backend_draw_rect,
+    .present = sdl_backend_present,
+    .load_img_texture = sdl_backend_load_img_texture,
+    .load_img_surface = sdl_backend_load_img_surface,
+    .load_text_texture = sdl_backend_load_text_texture,
+    .load_surface_texture = sdl_backend_load_surface_texture,
+    .destroy_texture = sdl_backend_destroy_texture,
+    .render_texture = sdl_backend_render_texture,
+    .render_texture_regions = sdl_backend_render_texture_regions,
+    .render_sprites = sdl_backend_render_sprites,
+};
+
+static void null_backend_init(const char *title, int width, int height) {
+  null_width = width;
+  null_height = height;
+}
+
+static void null_backend_get_output_size(int *width, int *height) {
+  *width = null_width;
+  *height = null_height;
+}
+
+static void null_backend_clear(SDL_Color color) { null_counts.clears++; }
+
+static void null_backend_draw_triangles(const SDL_Vertex *vertices,
+                                        size_t num_vertices,
+                                        const int *indices,
+                                        size_t num_indices) {
+  null_counts.triangle_batches++;
+  null_counts.triangles += num_indices / 3;
+  null_counts.triangle_vertices += num_vertices;
+}
+
+static void null_backend_draw_rect(SDL_Rect rect, SDL_Color color) {
+  null_counts.rects++;
+}
+
+static void null_backend_present(void) { null_counts.frames++; }
+
+static SDL_Texture *null_backend_load_img_texture(const char *path) {
+  null_counts.images_loaded++;
+  return NULL;
+}
+
+static SDL_Surface *null_backend_load_img_surface(const char *path) {
+  null_counts.images_loaded++;
+  return NULL;
+}
+
+static SDL_Texture *null_backend_load_text_texture(TTF_Font *font,
+                                                   const char *msg,
+                                                   SDL_Color color) {
+  null_counts.texts_loaded++;
+  return NULL;
+}
+
+static SDL_Texture *null_backend_load_surface_texture(SDL_Surface *surface) {
+  null_counts.surfaces_loaded++;
+  return NULL;
+}
+
+static void null_backend_destroy_texture(SDL_Texture *texture) {
+  null_counts.textures_destroyed++;
+}
+
+static void null_backend_render_texture(SDL_Texture *texture,
+                                        const SDL_Rect *src, SDL_Rect box,
+                                        double angle) {
+  null_counts.textures++;
+}
+
+static void null_backend_render_texture_regions(SDL_Texture *texture,
+                                                const SDL_Rect *src,
+                                                const SDL_Rect *dst, size_t n,
+                                                SDL_Color color) {
+  null_counts.region_batches++;
+  null_counts.regions += n;
+}
+
+static void null_backend_render_sprites(SDL_Texture *texture,
+                                        const sprite_quad_t *quads, size_t n) {
+  null_counts.sprite_batches++;
+  null_counts.sprites += n;
+}
+
+const render_backend_t RENDER_BACKEND_NULL = {
+    .init = null_backend_init,
+    .get_output_size = null_backend_get_output_size,
+    .clear = null_backend_clear,
+    .draw_triangles = null_backend_draw_triangles,
+    .draw_rect = null_backend_draw_rect,
+    .present = null_backend_present,
+    .load_img_texture = null_backend_load_img_texture,
+    .load_img_surface = null_backend_load_img_surface,
+    .load_text_texture = null_backend_load_text_texture,
+    .load_surface_texture = null_backend_load_surface_texture,
+    .destroy_texture = null_backend_destroy_texture,
+    .render_texture = null_backend_render_texture,
+    .render_texture_regions = null_backend_render_texture_regions,
+    .render_sprites = null_backend_render_sprites,
+};
+
+render_counts_t render_null_get_counts(void) { return null_counts; }
+
+void render_null_reset_counts(void) {
+  null_counts = (render_counts_t){0};
+}
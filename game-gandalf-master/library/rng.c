@@ -0,0 +1,96 @@
+#include <assert.h>
+
+#include "rng.h"
+
+const uint64_t SPLITMIX_INCREMENT = 0x9e3779b97f4a7c15ULL;
+// xoshiro256's jump polynomial, equivalent to 2^128 calls to rng_next()
+const uint64_t RNG_JUMP[4] = {0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL,
+                              0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL};
+const double DOUBLE_UNIT = 1.0 / (1ULL << 53);
+
+static uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+/**
+ * Advances a splitmix64 generator, which spreads a seed over the state.
+ */
+static uint64_t splitmix64(uint64_t *x) {
+  uint64_t z = (*x += SPLITMIX_INCREMENT);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return z ^ (z >> 31);
+}
+
+/**
+ * Advances a generator by 2^128 numbers.
+ */
+static void rng_jump(rng_t *rng) {
+  uint64_t s[4] = {0, 0, 0, 0};
+  for (size_t i = 0; i < 4; i++) {
+    for (int b = 0; b < 64; b++) {
+      if (RNG_JUMP[i] & (1ULL << b)) {
+        for (size_t j = 0; j < 4; j++) {
+          s[j] ^= rng->s[j];
+        }
+      }
+      rng_next(rng);
+    }
+  }
+  for (size_t j = 0; j < 4; j++) {
+    rng->s[j] = s[j];
+  }
+}
+
+rng_t rng_init(uint64_t seed, uint64_t stream) {
+  rng_t rng;
+  // splitmix64 never produces four zeros in a row, which xoshiro can't leave
+  for (size_t i = 0; i < 4; i++) {
+    rng.s[i] = splitmix64(&seed);
+  }
+  for (uint64_t i = 0; i < stream; i++) {
+    rng_jump(&rng);
+  }
+  return rng;
+}
+
+uint64_t rng_next(rng_t *rng) {
+  uint64_t *s = rng->s;
+  uint64_t result = rotl(s[1] * 5, 7) * 9;
+  uint64_t t = s[1] << 17;
+  s[2] ^= s[0];
+  s[3] ^= s[1];
+  s[1] ^= s[2];
+  s[0] ^= s[3];
+  s[2] ^= t;
+  s[3] = rotl(s[3], 45);
+  return result;
+}
+
+double rng_double(rng_t *rng) { return (rng_next(rng) >> 11) * DOUBLE_UNIT; }
+
+double rng_range(rng_t *rng, double low, double high) {
+  return low + (high - low) * rng_double(rng);
+}
+
+uint32_t rng_below(rng_t *rng, uint32_t n) {
+  assert(n > 0);
+  // Lemire's multiply-shift, rejecting the few values that would be biased
+  uint64_t product = (rng_next(rng) >> 32) * n;
+  uint32_t low = (uint32_t)product;
+  if (low < n) {
+    uint32_t threshold = -n % n;
+    while (low < threshold) {
+      product = (rng_next(rng) >> 32) * n;
+      low = (uint32_t)product;
+    }
+  }
+  return product >> 32;
+}
+
+void rng_fill_doubles(rng_t *rng, double *values, size_t n) {
+  // a local copy of the state lets the compiler keep it in registers
+  rng_t local = *rng;
+  for (size_t i = 0; i < n; i++) {
+    values[i] = (rng_next(&local) >> 11) * DOUBLE_UNIT;
+  }
+  *rng = local;
+}
@@ -1,20 +1,230 @@
 #include <assert.h>
+#include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
 
 #include "asset.h"
 #include "forces.h"
+#include "frame_timer.h"
 #include "scene.h"
+#include "spatial_hash.h"
+#include "thread_pool.h"
 
 const size_t INITIAL_NUM_BOD = 100;
 const size_t INITIAL_NUM_FCREATOR = 10;
+const double BROADPHASE_CELL_SIZE = 100;
+const size_t NUM_CATEGORIES = 32; // one per bit of a body's category mask
+const size_t INITIAL_NUM_CANDIDATES = 16;
+const body_handle_t BODY_HANDLE_NULL = {0, 0};
+const uint32_t NO_FREE_SLOT = UINT32_MAX;
+const uint32_t PENDING_BODY = UINT32_MAX; // `dense` of a queued body's slot
+const size_t INITIAL_NUM_COMMANDS = 16;
+// the fewest bodies worth integrating on a thread of their own
+const size_t MIN_PARALLEL_BODIES = 1024;
+// the fewest candidate pairs worth testing on a thread of their own
+const size_t MIN_PARALLEL_CANDIDATES = 64;
+const uint64_t FNV_OFFSET_BASIS = 14695981039346656037ULL;
+const uint64_t FNV_PRIME = 1099511628211ULL;
+
+/**
+ * An entry of the scene's handle table.
+ * While its body is alive, `dense` is the body's index in the scene.
+ * Once the body is freed, the generation is bumped, so its handles go stale,
+ * and the entry joins the free list through `next_free`.
+ */
+typedef struct handle_slot {
+  uint32_t generation;
+  uint32_t dense;
+  uint32_t next_free;
+} handle_slot_t;
+
+typedef enum {
+  COMMAND_ADD_BODY,
+  COMMAND_ADD_FORCE_CREATOR,
+} scene_command_type_t;
+
+/**
+ * A change to a scene queued during a tick, see scene_apply_commands().
+ */
+typedef struct scene_command {
+  scene_command_type_t type;
+  body_t *body;              // for COMMAND_ADD_BODY
+  uint32_t handle_index;     // for COMMAND_ADD_BODY
+  fcreator_storer_t *storer; // for COMMAND_ADD_FORCE_CREATOR
+} scene_command_t;
+
+/**
+ * A broadphase pair that some collision rule applies to.
+ * The narrowphase fills in `collided` and `axis`.
+ */
+typedef struct collision_candidate {
+  body_t *body1;
+  body_t *body2;
+  bool collided;
+  vector_t axis;
+} collision_candidate_t;
+
+typedef struct collision_rule {
+  collision_handler_t handler;
+  void *aux;
+  double force_const;
+  bool swapped; // registered as (category2, category1)
+} collision_rule_t;
 
 struct scene {
   size_t num_bodies;
   list_t *bodies;
+  // the bodies' dynamic state, in the same order as `bodies`
+  body_arrays_t arrays;
+  size_t body_capacity;
+
+  // handle table; entry 0 is reserved so BODY_HANDLE_NULL is never valid
+  handle_slot_t *handle_slots;
+  size_t num_handle_slots;
+  size_t handle_capacity;
+  uint32_t free_handle;
+  // the handle table index of the body at each index, parallel to `bodies`
+  uint32_t *dense_handles;
   list_t *force_creators;
+  spatial_hash_t *broadphase;
+
+  // NUM_CATEGORIES x NUM_CATEGORIES table, indexed by category bit numbers
+  collision_rule_t *rules;
+  // pairs touching during this tick and the last one
+  pair_set_t *contacts;
+  pair_set_t *prev_contacts;
+  // pairs to run the narrowphase on this tick, in dispatch order
+  collision_candidate_t *candidates;
+  size_t num_candidates;
+  size_t candidate_capacity;
+
+  // changes queued with scene_queue_*(), in the order they were queued
+  scene_command_t *commands;
+  size_t num_commands;
+  size_t command_capacity;
+  bool ticking;
+
+  // NULL while the scene runs on one thread
+  thread_pool_t *pool;
+  // one per thread, for the force creators running on it
+  force_log_t **force_logs;
+  size_t num_force_logs;
+
+  // time carried over by scene_step_fixed() and the tick length it used
+  double accumulator;
+  double step_dt;
+
+  scene_stats_t stats;
 };
 
+/**
+ * A batch of jobs that each run a contiguous chunk of the force creators in
+ * [start, end), or the bodies to integrate in parallel.
+ */
+typedef struct scene_job {
+  scene_t *scene;
+  size_t start;
+  size_t end;
+  size_t num_chunks;
+  double dt;
+} scene_job_t;
+
+/**
+ * Grows the body arrays of a scene until they can hold `needed` bodies.
+ * Attached bodies reach the arrays through `scene->arrays`,
+ * so they don't need to be told when the arrays move.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param needed the number of bodies the arrays must be able to hold
+ */
+static void scene_reserve_bodies(scene_t *scene, size_t needed) {
+  if (needed <= scene->body_capacity) {
+    return;
+  }
+  size_t capacity = scene->body_capacity ? scene->body_capacity : 1;
+  while (capacity < needed) {
+    capacity *= 2;
+  }
+  body_arrays_t *arrays = &scene->arrays;
+  arrays->position = realloc(arrays->position, sizeof(vector_t) * capacity);
+  arrays->velocity = realloc(arrays->velocity, sizeof(vector_t) * capacity);
+  arrays->force = realloc(arrays->force, sizeof(vector_t) * capacity);
+  arrays->impulse = realloc(arrays->impulse, sizeof(vector_t) * capacity);
+  arrays->inverse_mass =
+      realloc(arrays->inverse_mass, sizeof(double) * capacity);
+  arrays->angle = realloc(arrays->angle, sizeof(double) * capacity);
+  arrays->angular_velocity =
+      realloc(arrays->angular_velocity, sizeof(double) * capacity);
+  arrays->prev_position =
+      realloc(arrays->prev_position, sizeof(vector_t) * capacity);
+  arrays->prev_angle = realloc(arrays->prev_angle, sizeof(double) * capacity);
+  scene->dense_handles =
+      realloc(scene->dense_handles, sizeof(uint32_t) * capacity);
+  assert(arrays->position && arrays->velocity && arrays->force &&
+         arrays->impulse && arrays->inverse_mass && arrays->angle &&
+         arrays->angular_velocity && arrays->prev_position &&
+         arrays->prev_angle && scene->dense_handles);
+  scene->body_capacity = capacity;
+}
+
+/**
+ * Moves the state of the body in slot `from` to slot `to`.
+ */
+static void scene_move_slot(scene_t *scene, size_t from, size_t to) {
+  body_arrays_t *arrays = &scene->arrays;
+  arrays->position[to] = arrays->position[from];
+  arrays->velocity[to] = arrays->velocity[from];
+  arrays->force[to] = arrays->force[from];
+  arrays->impulse[to] = arrays->impulse[from];
+  arrays->inverse_mass[to] = arrays->inverse_mass[from];
+  arrays->angle[to] = arrays->angle[from];
+  arrays->angular_velocity[to] = arrays->angular_velocity[from];
+  arrays->prev_position[to] = arrays->prev_position[from];
+  arrays->prev_angle[to] = arrays->prev_angle[from];
+
+  uint32_t handle_index = scene->dense_handles[from];
+  scene->dense_handles[to] = handle_index;
+  scene->handle_slots[handle_index].dense = to;
+}
+
+/**
+ * Takes an entry of the handle table for a new body, reusing freed entries
+ * before growing the table.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @return the index of the entry
+ */
+static uint32_t scene_alloc_handle(scene_t *scene) {
+  if (scene->free_handle != NO_FREE_SLOT) {
+    uint32_t index = scene->free_handle;
+    scene->free_handle = scene->handle_slots[index].next_free;
+    return index;
+  }
+  if (scene->num_handle_slots == scene->handle_capacity) {
+    scene->handle_capacity *= 2;
+    scene->handle_slots = realloc(scene->handle_slots, sizeof(handle_slot_t) *
+                                                           scene->handle_capacity);
+    assert(scene->handle_slots);
+  }
+  uint32_t index = scene->num_handle_slots++;
+  scene->handle_slots[index].generation = 1;
+  return index;
+}
+
+/**
+ * Returns an entry of the handle table to the free list,
+ * making every handle to it stale.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param index the index of the entry
+ */
+static void scene_free_handle(scene_t *scene, uint32_t index) {
+  handle_slot_t *slot = &scene->handle_slots[index];
+  slot->generation++;
+  slot->next_free = scene->free_handle;
+  scene->free_handle = index;
+}
+
 scene_t *scene_init() {
   scene_t *scene = malloc(sizeof(scene_t));
   assert(scene);
@@ -23,12 +233,72 @@ scene_t *scene_init() {
   scene->force_creators =
       list_init(INITIAL_NUM_FCREATOR, (free_func_t)fcreator_storer_free);
   scene->num_bodies = 0;
+  scene->body_capacity = 0;
+  scene->arrays = (body_arrays_t){NULL, NULL, NULL, NULL, NULL,
+                                  NULL, NULL, NULL, NULL};
+  scene->dense_handles = NULL;
+  scene_reserve_bodies(scene, INITIAL_NUM_BOD);
+  scene->handle_slots = malloc(sizeof(handle_slot_t) * INITIAL_NUM_BOD);
+  assert(scene->handle_slots);
+  scene->handle_capacity = INITIAL_NUM_BOD;
+  scene->handle_slots[0] = (handle_slot_t){0, 0, NO_FREE_SLOT};
+  scene->num_handle_slots = 1;
+  scene->free_handle = NO_FREE_SLOT;
+  scene->broadphase = spatial_hash_init(BROADPHASE_CELL_SIZE);
+
+  scene->rules =
+      calloc(NUM_CATEGORIES * NUM_CATEGORIES, sizeof(collision_rule_t));
+  assert(scene->rules);
+  scene->contacts = pair_set_init();
+  scene->prev_contacts = pair_set_init();
+  scene->candidates =
+      malloc(sizeof(collision_candidate_t) * INITIAL_NUM_CANDIDATES);
+  assert(scene->candidates);
+  scene->num_candidates = 0;
+  scene->candidate_capacity = INITIAL_NUM_CANDIDATES;
+  scene->commands = malloc(sizeof(scene_command_t) * INITIAL_NUM_COMMANDS);
+  assert(scene->commands);
+  scene->num_commands = 0;
+  scene->command_capacity = INITIAL_NUM_COMMANDS;
+  scene->ticking = false;
+  scene->pool = NULL;
+  scene->force_logs = NULL;
+  scene->num_force_logs = 0;
+  scene->accumulator = 0;
+  scene->step_dt = 0;
+  scene_reset_stats(scene);
   return scene;
 }
 
 void scene_free(scene_t *scene) {
+  for (size_t i = 0; i < scene->num_commands; i++) {
+    scene_command_t *command = &scene->commands[i];
+    if (command->type == COMMAND_ADD_BODY) {
+      body_free(command->body);
+    } else {
+      fcreator_storer_free(command->storer);
+    }
+  }
+  free(scene->commands);
+  scene_set_num_threads(scene, 1);
   list_free(scene->bodies);
+  free(scene->arrays.position);
+  free(scene->arrays.velocity);
+  free(scene->arrays.force);
+  free(scene->arrays.impulse);
+  free(scene->arrays.inverse_mass);
+  free(scene->arrays.angle);
+  free(scene->arrays.angular_velocity);
+  free(scene->arrays.prev_position);
+  free(scene->arrays.prev_angle);
+  free(scene->dense_handles);
+  free(scene->handle_slots);
   list_free(scene->force_creators);
+  spatial_hash_free(scene->broadphase);
+  free(scene->rules);
+  pair_set_free(scene->contacts);
+  pair_set_free(scene->prev_contacts);
+  free(scene->candidates);
   free(scene);
 }
 
@@ -39,12 +309,86 @@ body_t *scene_get_body(scene_t *scene, size_t index) {
   return list_get(scene->bodies, index);
 }
 
-void scene_add_body(scene_t *scene, body_t *body) {
-  assert(body);
+/**
+ * Appends a body to a scene under an already allocated handle.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param body a pointer to the body to add to the scene
+ * @param handle_index the body's entry in the handle table
+ */
+static void scene_insert_body(scene_t *scene, body_t *body,
+                              uint32_t handle_index) {
+  scene_reserve_bodies(scene, scene->num_bodies + 1);
+  size_t dense = scene->num_bodies;
+  body_attach(body, &scene->arrays, dense);
+  scene->handle_slots[handle_index].dense = dense;
+  scene->dense_handles[dense] = handle_index;
   scene->num_bodies++;
   list_add(scene->bodies, body);
 }
 
+body_handle_t scene_add_body(scene_t *scene, body_t *body) {
+  assert(body);
+  assert(!scene->ticking);
+  uint32_t handle_index = scene_alloc_handle(scene);
+  scene_insert_body(scene, body, handle_index);
+  return (body_handle_t){handle_index,
+                         scene->handle_slots[handle_index].generation};
+}
+
+/**
+ * Appends a command to a scene's queue.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param command the command to apply in the next scene_tick()
+ */
+static void scene_push_command(scene_t *scene, scene_command_t command) {
+  if (scene->num_commands == scene->command_capacity) {
+    scene->command_capacity *= 2;
+    scene->commands = realloc(scene->commands, sizeof(scene_command_t) *
+                                                   scene->command_capacity);
+    assert(scene->commands);
+  }
+  scene->commands[scene->num_commands++] = command;
+}
+
+body_handle_t scene_queue_add_body(scene_t *scene, body_t *body) {
+  assert(body);
+  uint32_t handle_index = scene_alloc_handle(scene);
+  scene->handle_slots[handle_index].dense = PENDING_BODY;
+  scene_push_command(scene,
+                     (scene_command_t){.type = COMMAND_ADD_BODY,
+                                       .body = body,
+                                       .handle_index = handle_index});
+  return (body_handle_t){handle_index,
+                         scene->handle_slots[handle_index].generation};
+}
+
+body_t *scene_get_body_by_handle(scene_t *scene, body_handle_t handle) {
+  if (handle.index == 0 || handle.index >= scene->num_handle_slots) {
+    return NULL;
+  }
+  handle_slot_t *slot = &scene->handle_slots[handle.index];
+  if (slot->generation != handle.generation || slot->dense == PENDING_BODY) {
+    return NULL;
+  }
+  return list_get(scene->bodies, slot->dense);
+}
+
+body_handle_t scene_get_handle(scene_t *scene, size_t index) {
+  assert(index < scene->num_bodies);
+  uint32_t handle_index = scene->dense_handles[index];
+  return (body_handle_t){handle_index,
+                         scene->handle_slots[handle_index].generation};
+}
+
+void scene_remove_body_by_handle(scene_t *scene, body_handle_t handle) {
+  body_t *body = scene_get_body_by_handle(scene, handle);
+  if (body != NULL) {
+    body_remove(body);
+  }
+}
+
 void scene_remove_body(scene_t *scene, size_t index) {
   assert(0 <= index && index < list_size(scene->bodies));
   body_t *body = scene_get_body(scene, index);
@@ -56,39 +400,307 @@ void scene_add_force_creator(scene_t *scene, force_creator_t force_creator,
   scene_add_bodies_force_creator(scene, force_creator, aux, list_init(0, NULL));
 }
 
+/**
+ * Starts running a stored force creator every tick,
+ * and records it on the bodies it acts on.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param fstore the force creator to add
+ */
+static void scene_insert_force_creator(scene_t *scene,
+                                       fcreator_storer_t *fstore) {
+  list_add(scene->force_creators, fstore);
+  list_t *bodies = fcreator_storer_get_bodies(fstore);
+  for (size_t i = 0; i < list_size(bodies); i++) {
+    body_add_force_creator(list_get(bodies, i), fstore);
+  }
+}
+
 void scene_add_bodies_force_creator(scene_t *scene, force_creator_t forcer,
                                     void *aux, list_t *bodies) {
+  assert(!scene->ticking);
+  scene_insert_force_creator(scene, fcreator_storer_init(forcer, aux, bodies));
+}
+
+void scene_add_serial_force_creator(scene_t *scene, force_creator_t forcer,
+                                    void *aux, list_t *bodies) {
+  assert(!scene->ticking);
   fcreator_storer_t *fstore = fcreator_storer_init(forcer, aux, bodies);
-  list_add(scene->force_creators, fstore);
+  fcreator_storer_set_serial(fstore);
+  scene_insert_force_creator(scene, fstore);
 }
 
-list_t *scene_tick(scene_t *scene, list_t *assets, double dt) {
-  list_t *destroyed_asters = list_init(5, NULL);
-  for (size_t i = 0; i < list_size(scene->force_creators); i++) {
-    fcreator_storer_t *storer = list_get(scene->force_creators, i);
+void scene_queue_bodies_force_creator(scene_t *scene, force_creator_t forcer,
+                                      void *aux, list_t *bodies) {
+  scene_push_command(
+      scene, (scene_command_t){.type = COMMAND_ADD_FORCE_CREATOR,
+                               .storer = fcreator_storer_init(forcer, aux,
+                                                              bodies)});
+}
+
+void scene_add_collision_rule(scene_t *scene, uint32_t category1,
+                              uint32_t category2, collision_handler_t handler,
+                              void *aux, double force_const) {
+  assert(handler);
+  for (size_t i = 0; i < NUM_CATEGORIES; i++) {
+    if (!(category1 & ((uint32_t)1 << i))) {
+      continue;
+    }
+    for (size_t j = 0; j < NUM_CATEGORIES; j++) {
+      if (!(category2 & ((uint32_t)1 << j))) {
+        continue;
+      }
+      scene->rules[i * NUM_CATEGORIES + j] =
+          (collision_rule_t){handler, aux, force_const, false};
+      if (i != j) {
+        scene->rules[j * NUM_CATEGORIES + i] =
+            (collision_rule_t){handler, aux, force_const, true};
+      }
+    }
+  }
+}
+
+/**
+ * Returns whether any collision rule applies to bodies in the given categories.
+ */
+static bool scene_has_rule(scene_t *scene, uint32_t category1,
+                           uint32_t category2) {
+  for (size_t i = 0; i < NUM_CATEGORIES; i++) {
+    if (!(category1 & ((uint32_t)1 << i))) {
+      continue;
+    }
+    for (size_t j = 0; j < NUM_CATEGORIES; j++) {
+      if ((category2 & ((uint32_t)1 << j)) &&
+          scene->rules[i * NUM_CATEGORIES + j].handler != NULL) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+/**
+ * Calls the handler of every rule matching the categories of the two bodies.
+ * Rules registered with the categories the other way around get the bodies
+ * (and the axis) swapped, so handlers always see them in registration order.
+ */
+static void scene_run_rules(scene_t *scene, collision_candidate_t *hit) {
+  uint32_t category1 = body_get_category(hit->body1);
+  uint32_t category2 = body_get_category(hit->body2);
+  for (size_t i = 0; i < NUM_CATEGORIES; i++) {
+    if (!(category1 & ((uint32_t)1 << i))) {
+      continue;
+    }
+    for (size_t j = 0; j < NUM_CATEGORIES; j++) {
+      collision_rule_t *rule = &scene->rules[i * NUM_CATEGORIES + j];
+      if (!(category2 & ((uint32_t)1 << j)) || rule->handler == NULL) {
+        continue;
+      }
+      if (rule->swapped) {
+        rule->handler(hit->body2, hit->body1, vec_negate(hit->axis), rule->aux,
+                      rule->force_const);
+      } else {
+        rule->handler(hit->body1, hit->body2, hit->axis, rule->aux,
+                      rule->force_const);
+      }
+    }
+  }
+}
+
+/**
+ * Fills the lazy caches find_collision() reads, so that it only reads the
+ * polygon: its vertices, and its bounding box, which
+ * polygon_get_bounds_min() computes together with the maximum.
+ */
+static void scene_warm_polygon(polygon_t *polygon) {
+  polygon_get_vertices(polygon);
+  polygon_get_bounds_min(polygon);
+}
+
+/**
+ * Gathers the broadphase pairs covered by a collision rule into the scene's
+ * flat candidate array, in broadphase order.
+ * On several threads, also computes the vertices and bounding boxes of their
+ * bodies up front, since the narrowphase would otherwise fill the bodies'
+ * lazy caches from several threads at once.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ */
+static void scene_gather_candidates(scene_t *scene) {
+  scene->num_candidates = 0;
+  for (size_t i = 0; i < spatial_hash_num_pairs(scene->broadphase); i++) {
+    body_pair_t pair = spatial_hash_get_pair(scene->broadphase, i);
+    if (!scene_has_rule(scene, body_get_category(pair.body1),
+                        body_get_category(pair.body2))) {
+      continue;
+    }
+    if (scene->num_candidates == scene->candidate_capacity) {
+      scene->candidate_capacity *= 2;
+      scene->candidates =
+          realloc(scene->candidates,
+                  sizeof(collision_candidate_t) * scene->candidate_capacity);
+      assert(scene->candidates);
+    }
+    scene->candidates[scene->num_candidates++] =
+        (collision_candidate_t){pair.body1, pair.body2, false, VEC_ZERO};
+    if (scene->pool != NULL) {
+      scene_warm_polygon(body_get_polygon(pair.body1));
+      scene_warm_polygon(body_get_polygon(pair.body2));
+    }
+  }
+}
+
+/**
+ * Runs find_collision() on a chunk of the candidate pairs.
+ * Each call only reads the bodies and writes its own candidate,
+ * so chunks can run concurrently.
+ */
+static void scene_narrowphase_range(void *aux, size_t start, size_t end) {
+  scene_t *scene = aux;
+  for (size_t i = start; i < end; i++) {
+    collision_candidate_t *candidate = &scene->candidates[i];
+    collision_info_t info = find_collision(candidate->body1, candidate->body2);
+    candidate->collided = info.collided;
+    candidate->axis = info.axis;
+  }
+}
+
+/**
+ * Runs the narrowphase on every broadphase pair covered by a collision rule,
+ * then calls the rules' handlers for the pairs that just started touching.
+ * Like create_collision(), a handler is only called once while its bodies
+ * stay in contact.
+ * The narrowphase is split between the scene's threads, but the handlers run
+ * on the calling thread in candidate order, so the results don't depend on
+ * the number of threads.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ */
+static void scene_dispatch_collisions(scene_t *scene) {
+  pair_set_t *contacts = scene->prev_contacts;
+  scene->prev_contacts = scene->contacts;
+  scene->contacts = contacts;
+  pair_set_clear(scene->contacts);
+
+  uint64_t start = timer_now_ns();
+  scene_gather_candidates(scene);
+  if (scene->pool == NULL) {
+    scene_narrowphase_range(scene, 0, scene->num_candidates);
+  } else {
+    thread_pool_parallel_for(scene->pool, scene_narrowphase_range, scene, 0,
+                             scene->num_candidates, MIN_PARALLEL_CANDIDATES);
+  }
+  uint64_t narrowphase_end = timer_now_ns();
+  scene->stats.narrowphase_ns += narrowphase_end - start;
+  scene->stats.pairs_tested += scene->num_candidates;
+
+  for (size_t i = 0; i < scene->num_candidates; i++) {
+    collision_candidate_t *hit = &scene->candidates[i];
+    // an earlier handler this tick may have destroyed one of the bodies
+    if (!hit->collided || body_is_removed(hit->body1) ||
+        body_is_removed(hit->body2) ||
+        pair_set_contains(scene->prev_contacts, hit->body1, hit->body2)) {
+      continue;
+    }
+    scene_run_rules(scene, hit);
+    scene->stats.collisions++;
+  }
+
+  // removed bodies are freed at the end of this tick, so they must not be
+  // remembered as touching anything
+  for (size_t i = 0; i < scene->num_candidates; i++) {
+    collision_candidate_t *hit = &scene->candidates[i];
+    if (hit->collided && !body_is_removed(hit->body1) &&
+        !body_is_removed(hit->body2)) {
+      pair_set_add(scene->contacts, hit->body1, hit->body2);
+    }
+  }
+  scene->stats.handlers_ns += timer_now_ns() - narrowphase_end;
+}
+
+bool scene_may_collide(scene_t *scene, body_t *body1, body_t *body2) {
+  return spatial_hash_has_pair(scene->broadphase, body1, body2);
+}
+
+/**
+ * Rebuilds the broadphase grid from the current positions of the bodies.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ */
+static void scene_update_broadphase(scene_t *scene) {
+  spatial_hash_clear(scene->broadphase);
+  for (size_t i = 0; i < scene->num_bodies; i++) {
+    body_t *body = scene_get_body(scene, i);
+    if (!body_is_removed(body)) {
+      spatial_hash_insert(scene->broadphase, body);
+    }
+  }
+  spatial_hash_build_pairs(scene->broadphase);
+}
+
+/**
+ * Frees the force creators acting on removed bodies.
+ * Each removed body marks the force creators it knows about, then the
+ * survivors are compacted in a single pass, so the cost is proportional to
+ * the removed bodies' own registrations plus one pass over the force creators.
+ * Must run before the removed bodies are freed.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ */
+static void scene_remove_force_creators(scene_t *scene) {
+  bool any_removed = false;
+  for (size_t i = 0; i < scene->num_bodies; i++) {
+    body_t *body = scene_get_body(scene, i);
+    if (!body_is_removed(body)) {
+      continue;
+    }
+    for (size_t j = 0; j < body_num_force_creators(body); j++) {
+      fcreator_storer_remove(body_get_force_creator(body, j));
+      any_removed = true;
+    }
+  }
+  if (!any_removed) {
+    return;
+  }
+
+  list_t *force_creators = scene->force_creators;
+  size_t kept = 0;
+  for (size_t i = 0; i < list_size(force_creators); i++) {
+    fcreator_storer_t *storer = list_get(force_creators, i);
+    if (!fcreator_storer_is_removed(storer)) {
+      list_set(force_creators, storer, kept++);
+      continue;
+    }
+    // the surviving bodies must forget it before it is freed
     list_t *creator_bodies = fcreator_storer_get_bodies(storer);
-    force_creator_t creator = fcreator_storer_get_creator(storer);
-    void *aux = fcreator_storer_get_aux(storer);
-    (*creator)(aux);
+    for (size_t k = 0; k < list_size(creator_bodies); k++) {
+      body_t *body = list_get(creator_bodies, k);
+      if (!body_is_removed(body)) {
+        body_remove_force_creator(body, storer);
+      }
+    }
+    fcreator_storer_free(storer);
+  }
+  while (list_size(force_creators) > kept) {
+    list_remove(force_creators, list_size(force_creators) - 1);
   }
+}
 
-  for (ssize_t i = 0; i < (ssize_t)(scene->num_bodies); i++) {
+/**
+ * Frees the removed bodies and compacts the surviving ones to the front of
+ * the scene in a single pass, so their slots stay contiguous for the
+ * integration loop.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param assets the assets to remove the removed bodies' assets from
+ * @param destroyed_asters a list to add the positions of removed asteroids to
+ */
+static void scene_remove_bodies(scene_t *scene, list_t *assets,
+                                list_t *destroyed_asters) {
+  size_t kept = 0;
+  for (size_t i = 0; i < scene->num_bodies; i++) {
     body_t *body = scene_get_body(scene, i);
     if (body_is_removed(body)) {
-      for (ssize_t j = 0; j < (ssize_t)(list_size(scene->force_creators));
-           j++) {
-        fcreator_storer_t *fstorer = list_get(scene->force_creators, j);
-        list_t *creator_bodies = fcreator_storer_get_bodies(fstorer);
-        for (size_t k = 0; k < list_size(creator_bodies); k++) {
-          body_t *kbody = list_get(creator_bodies, k);
-          if (kbody == body) {
-            list_remove(scene->force_creators, j);
-            fcreator_storer_free(fstorer);
-            j--;
-            break;
-          }
-        }
-      }
       for (ssize_t k = 0; k < (ssize_t)(list_size(assets)); k++) {
         if (asset_get_body(list_get(assets, k)) == body) {
           list_remove(assets, k);
@@ -96,16 +708,251 @@ list_t *scene_tick(scene_t *scene, list_t *assets, double dt) {
         }
       }
       if (strcmp(body_get_info(body), "Asteroid") == 0) {
-        vector_t centroid = body_get_centroid(body);
-        list_add(destroyed_asters, &centroid);
+        vector_t *centroid = malloc(sizeof(vector_t));
+        assert(centroid);
+        *centroid = body_get_centroid(body);
+        list_add(destroyed_asters, centroid);
       }
-      list_remove(scene->bodies, i);
       body_free(body);
-      scene->num_bodies--;
-      i--;
+      scene_free_handle(scene, scene->dense_handles[i]);
+      continue;
+    }
+    if (kept != i) {
+      list_set(scene->bodies, body, kept);
+      scene_move_slot(scene, i, kept);
+      body_set_slot(body, kept);
+    }
+    kept++;
+  }
+  while (list_size(scene->bodies) > kept) {
+    list_remove(scene->bodies, list_size(scene->bodies) - 1);
+  }
+  scene->num_bodies = kept;
+}
+
+/**
+ * Applies every structural change to a scene that was deferred during the
+ * tick, in one pass: queued bodies and force creators are added in the order
+ * they were queued, then force creators and bodies marked for removal are
+ * freed. Queued force creators are registered before the removals, so they
+ * are removed along with any of their bodies that were also removed.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param assets the game's assets, some of which may reference removed bodies
+ * @param destroyed_asters a list to add the positions of removed asteroids to
+ */
+static void scene_apply_commands(scene_t *scene, list_t *assets,
+                                 list_t *destroyed_asters) {
+  for (size_t i = 0; i < scene->num_commands; i++) {
+    scene_command_t *command = &scene->commands[i];
+    if (command->type == COMMAND_ADD_BODY) {
+      scene_insert_body(scene, command->body, command->handle_index);
     } else {
-      body_tick(body, dt);
+      scene_insert_force_creator(scene, command->storer);
+    }
+  }
+  scene->num_commands = 0;
+
+  scene_remove_force_creators(scene);
+  scene_remove_bodies(scene, assets, destroyed_asters);
+}
+
+void scene_set_num_threads(scene_t *scene, size_t num_threads) {
+  assert(num_threads >= 1);
+  if (scene->pool != NULL) {
+    thread_pool_free(scene->pool);
+    for (size_t i = 0; i < scene->num_force_logs; i++) {
+      force_log_free(scene->force_logs[i]);
+    }
+    free(scene->force_logs);
+    scene->pool = NULL;
+    scene->force_logs = NULL;
+    scene->num_force_logs = 0;
+  }
+  if (num_threads == 1) {
+    return;
+  }
+  scene->pool = thread_pool_init(num_threads);
+  scene->num_force_logs = thread_pool_num_threads(scene->pool);
+  scene->force_logs = malloc(sizeof(force_log_t *) * scene->num_force_logs);
+  assert(scene->force_logs);
+  for (size_t i = 0; i < scene->num_force_logs; i++) {
+    scene->force_logs[i] = force_log_init();
+  }
+}
+
+/**
+ * Gets the bounds of one of the equal chunks a job batch is split into.
+ */
+static void scene_job_chunk(scene_job_t *job, size_t index, size_t *start,
+                            size_t *end) {
+  size_t count = job->end - job->start;
+  *start = job->start + count * index / job->num_chunks;
+  *end = job->start + count * (index + 1) / job->num_chunks;
+}
+
+static void run_force_creator(fcreator_storer_t *storer) {
+  force_creator_t creator = fcreator_storer_get_creator(storer);
+  (*creator)(fcreator_storer_get_aux(storer));
+}
+
+/**
+ * Runs one chunk of force creators, logging their forces in the chunk's log.
+ */
+static void scene_force_creator_job(void *aux, size_t index) {
+  scene_job_t *job = aux;
+  size_t start, end;
+  scene_job_chunk(job, index, &start, &end);
+  force_log_begin(job->scene->force_logs[index]);
+  for (size_t i = start; i < end; i++) {
+    run_force_creator(list_get(job->scene->force_creators, i));
+  }
+  force_log_end();
+}
+
+static void scene_integrate_range(void *aux, size_t start, size_t end) {
+  scene_job_t *job = aux;
+  body_arrays_integrate(&job->scene->arrays, start, end, job->dt);
+}
+
+/**
+ * Runs every force creator in the scene. On several threads, runs of
+ * consecutive force creators that aren't serial are split between the
+ * threads, and their logs replayed in order before the next serial one runs,
+ * so every force is added in the same order as on one thread.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ */
+static void scene_run_force_creators(scene_t *scene) {
+  list_t *force_creators = scene->force_creators;
+  size_t num_force_creators = list_size(force_creators);
+  if (scene->pool == NULL) {
+    for (size_t i = 0; i < num_force_creators; i++) {
+      run_force_creator(list_get(force_creators, i));
+    }
+    return;
+  }
+
+  size_t i = 0;
+  while (i < num_force_creators) {
+    if (fcreator_storer_is_serial(list_get(force_creators, i))) {
+      run_force_creator(list_get(force_creators, i));
+      i++;
+      continue;
+    }
+    size_t end = i + 1;
+    while (end < num_force_creators &&
+           !fcreator_storer_is_serial(list_get(force_creators, end))) {
+      end++;
+    }
+    size_t num_chunks = scene->num_force_logs;
+    if (end - i < num_chunks) {
+      num_chunks = end - i;
+    }
+    scene_job_t job = {scene, i, end, num_chunks, 0};
+    thread_pool_run(scene->pool, scene_force_creator_job, &job, num_chunks);
+    for (size_t j = 0; j < num_chunks; j++) {
+      force_log_apply(scene->force_logs[j]);
+    }
+    i = end;
+  }
+}
+
+/**
+ * Ticks every body in the scene, on several threads if the scene has enough
+ * bodies. Each body is integrated independently, so this gives the same
+ * results on any number of threads.
+ *
+ * @param scene a pointer to a scene returned from scene_init()
+ * @param dt the time elapsed since the last tick, in seconds
+ */
+static void scene_integrate(scene_t *scene, double dt) {
+  if (scene->pool == NULL) {
+    body_arrays_integrate(&scene->arrays, 0, scene->num_bodies, dt);
+    return;
+  }
+  scene_job_t job = {scene, 0, scene->num_bodies, 0, dt};
+  thread_pool_parallel_for(scene->pool, scene_integrate_range, &job, 0,
+                           scene->num_bodies, MIN_PARALLEL_BODIES);
+}
+
+list_t *scene_tick(scene_t *scene, list_t *assets, double dt) {
+  list_t *destroyed_asters = list_init(5, free);
+  scene_stats_t *stats = &scene->stats;
+  scene->ticking = true;
+  uint64_t start = timer_now_ns();
+  scene_update_broadphase(scene);
+  uint64_t broadphase_end = timer_now_ns();
+  scene_run_force_creators(scene);
+  stats->force_creators_ns += timer_now_ns() - broadphase_end;
+  // times its own narrowphase and handlers
+  scene_dispatch_collisions(scene);
+  scene->ticking = false;
+
+  uint64_t commands_start = timer_now_ns();
+  scene_apply_commands(scene, assets, destroyed_asters);
+  uint64_t integrate_start = timer_now_ns();
+  scene_integrate(scene, dt);
+  uint64_t end = timer_now_ns();
+
+  stats->broadphase_ns += broadphase_end - start;
+  stats->commands_ns += integrate_start - commands_start;
+  stats->integrate_ns += end - integrate_start;
+  stats->ticks++;
+  return destroyed_asters;
+}
+
+list_t *scene_step_fixed(scene_t *scene, list_t *assets, double dt,
+                         double dt_fixed, size_t max_substeps) {
+  assert(dt_fixed > 0);
+  list_t *destroyed_asters = list_init(5, free);
+  scene->step_dt = dt_fixed;
+  scene->accumulator += dt;
+  for (size_t i = 0; i < max_substeps && scene->accumulator >= dt_fixed;
+       i++) {
+    list_t *tick_asters = scene_tick(scene, assets, dt_fixed);
+    while (list_size(tick_asters) > 0) {
+      list_add(destroyed_asters, list_remove(tick_asters, 0));
     }
+    list_free(tick_asters);
+    scene->accumulator -= dt_fixed;
+  }
+  if (scene->accumulator >= dt_fixed) {
+    scene->accumulator = fmod(scene->accumulator, dt_fixed);
   }
   return destroyed_asters;
 }
+
+double scene_get_interpolation_alpha(scene_t *scene) {
+  if (scene->step_dt == 0) {
+    return 1;
+  }
+  return scene->accumulator / scene->step_dt;
+}
+
+/**
+ * Adds some bytes to a 64-bit FNV-1a hash.
+ */
+static uint64_t fnv1a(uint64_t hash, const void *data, size_t size) {
+  const uint8_t *bytes = data;
+  for (size_t i = 0; i < size; i++) {
+    hash = (hash ^ bytes[i]) * FNV_PRIME;
+  }
+  return hash;
+}
+
+uint64_t scene_digest(scene_t *scene) {
+  body_arrays_t *arrays = &scene->arrays;
+  size_t n = scene->num_bodies;
+  uint64_t hash = fnv1a(FNV_OFFSET_BASIS, &n, sizeof(n));
+  hash = fnv1a(hash, arrays->position, sizeof(vector_t) * n);
+  hash = fnv1a(hash, arrays->velocity, sizeof(vector_t) * n);
+  hash = fnv1a(hash, arrays->angle, sizeof(double) * n);
+  return fnv1a(hash, arrays->angular_velocity, sizeof(double) * n);
+}
+
+scene_stats_t scene_get_stats(scene_t *scene) { return scene->stats; }
+
+void scene_reset_stats(scene_t *scene) {
+  scene->stats = (scene_stats_t){0, 0, 0, 0, 0, 0, 0, 0, 0};
+}
@@ -1,7 +1,9 @@
 #include "sdl_wrapper.h"
 #include "asset_cache.h"
+#include "input_log.h"
 #include <assert.h>
 #include <math.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <time.h>
 
@@ -9,9 +11,14 @@ const char WINDOW_TITLE[] = "a5traeμs";
 const int WINDOW_WIDTH = 1000;
 const int WINDOW_HEIGHT = 500;
 const double MS_PER_S = 1e3;
+const size_t FRAME_HISTORY = 240; // about 4 seconds at 60 fps
+const uint32_t KEYFRAME_INTERVAL = 120; // frames between keyframes
 
 const SDL_Color BLACK = {0, 0, 0};
+const SDL_Color WHITE = {255, 255, 255};
 const double IMG_SCALE = 1;
+const size_t INITIAL_NUM_SPRITES = 64;
+const size_t INITIAL_NUM_POLYGON_VERTICES = 256;
 
 /**
  * The coordinate at the center of the screen.
@@ -22,13 +29,9 @@ vector_t center;
  */
 vector_t max_diff;
 /**
- * The SDL window where the scene is rendered.
+ * What the scene is drawn with, see sdl_set_render_backend().
  */
-SDL_Window *window;
-/**
- * The renderer used to draw the scene.
- */
-SDL_Renderer *renderer;
+const render_backend_t *backend = &RENDER_BACKEND_SDL;
 /**
  * The keypress handler, or NULL if none has been configured.
  */
@@ -43,20 +46,107 @@ mouse_handler_t mouse_handler = NULL;
  */
 uint32_t key_start_timestamp;
 /**
- * The value of clock() when time_since_last_tick() was last called.
+ * The value of timer_now_ns() when time_since_last_tick() was last called.
  * Initially 0.
  */
-clock_t last_clock = 0;
+uint64_t last_tick_ns = 0;
+/**
+ * The durations of the latest frames, as measured by time_since_last_tick().
+ * Allocated on first use.
+ */
+frame_stats_t *frame_stats = NULL;
+/**
+ * How far through their latest tick bodies are drawn.
+ */
+double render_alpha = 1;
+/**
+ * The recording being written or replayed, or NULL if neither.
+ * See sdl_record_input() and sdl_replay_input().
+ */
+input_log_t *recording = NULL;
+input_log_t *replay = NULL;
+/**
+ * The number of frames sdl_is_done() has finished.
+ */
+size_t frame_index = 0;
+/**
+ * The frame time time_since_last_tick() last returned.
+ */
+uint32_t frame_dt_ns = 0;
+/**
+ * The seed returned by sdl_get_seed(), once chosen.
+ */
+uint32_t seed;
+bool has_seed = false;
+/**
+ * Replay statistics: when the replay started, the keyframes compared so far,
+ * how many didn't match and the frame of the first one that didn't,
+ * and the scene last passed to sdl_track_scene().
+ */
+uint64_t replay_start_ns;
+size_t keyframes_checked = 0;
+size_t keyframe_mismatches = 0;
+size_t first_mismatch_frame = 0;
+scene_t *tracked_scene = NULL;
+
+/**
+ * A sprite waiting to be drawn: the layer it is drawn in, and the order
+ * sdl_render_sprite() was called in, which breaks ties between sprites
+ * of one texture so that they overlap as they would have unbatched.
+ */
+typedef struct queued_sprite {
+  size_t layer;
+  size_t order;
+  SDL_Texture *texture;
+  sprite_quad_t quad;
+} queued_sprite_t;
+
+/**
+ * The sprites rendered since the last flush_sprites(), and the quads of the
+ * batch being submitted. Both are grown to fit the busiest frame.
+ */
+queued_sprite_t *queued_sprites = NULL;
+sprite_quad_t *sprite_quads = NULL;
+size_t num_queued_sprites = 0;
+size_t sprite_capacity = 0;
+/**
+ * The layer, texture and reorderability of the last sprite. Runs of
+ * reorderable sprites share a layer, as do runs of other sprites of one
+ * texture, which are drawn in order anyway.
+ */
+size_t sprite_layer = 0;
+SDL_Texture *last_sprite_texture = NULL;
+bool last_sprite_reorderable = false;
+
+/**
+ * The triangles of the polygons drawn since the last flush_polygons(), in
+ * window pixels. Grown to fit the busiest frame, so drawing a frame
+ * allocates nothing once the buffers are big enough.
+ */
+SDL_Vertex *polygon_vertices = NULL;
+int *polygon_indices = NULL;
+size_t num_polygon_vertices = 0;
+size_t num_polygon_indices = 0;
+size_t polygon_vertex_capacity = 0;
+
+/**
+ * The keys sdl_is_done() polls, in the order their presses are handled.
+ */
+const struct {
+  input_key_t bit;
+  char key;
+} POLLED_KEYS[] = {
+    {INPUT_UP, UP_ARROW}, {INPUT_DOWN, DOWN_ARROW}, {INPUT_LEFT, LEFT_ARROW},
+    {INPUT_RIGHT, RIGHT_ARROW}, {INPUT_W, 'w'}, {INPUT_S, 's'},
+    {INPUT_A, 'a'}, {INPUT_D, 'd'}, {INPUT_M, 'm'}, {INPUT_V, 'v'},
+};
+const size_t NUM_POLLED_KEYS = sizeof(POLLED_KEYS) / sizeof(POLLED_KEYS[0]);
 
 /** Computes the center of the window in pixel coordinates */
 vector_t get_window_center(void) {
-  int *width = malloc(sizeof(*width)), *height = malloc(sizeof(*height));
-  assert(width);
-  assert(height);
-  SDL_GetWindowSize(window, width, height);
-  vector_t dimensions = {.x = *width, .y = *height};
-  free(width);
-  free(height);
+  int width, height;
+  backend->get_output_size(&width, &height);
+  vector_t dimensions = {.x = width, .y = height};
   return vec_multiply(0.5, dimensions);
 }
 
@@ -116,126 +206,348 @@ void sdl_init(vector_t min, vector_t max) {
   center = vec_multiply(0.5, vec_add(min, max));
   max_diff = vec_subtract(max, center);
 
-  SDL_Init(SDL_INIT_AUDIO);
-  SDL_Init(SDL_INIT_EVERYTHING);
-  window = SDL_CreateWindow(WINDOW_TITLE, SDL_WINDOWPOS_CENTERED,
-                            SDL_WINDOWPOS_CENTERED, WINDOW_WIDTH, WINDOW_HEIGHT,
-                            SDL_WINDOW_RESIZABLE);
-  renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_PRESENTVSYNC);
-  TTF_Init();
-  Mix_Init(MIX_INIT_OGG || MIX_INIT_WAVPACK);
-  Mix_OpenAudio(44100, MIX_DEFAULT_FORMAT, 2, 2048);
+  backend->init(WINDOW_TITLE, WINDOW_WIDTH, WINDOW_HEIGHT);
 }
 
-bool sdl_is_done(void *state) {
-  int x = 0, y = 0;
-  uint32_t bitmask = SDL_GetMouseState(&x, &y);
-  if (bitmask > 0 && SDL_BUTTON(bitmask) == 1) {
-    asset_cache_handle_buttons(state, (double)x, (double)y);
-    return false;
-  }
+void sdl_set_render_backend(const render_backend_t *render_backend) {
+  backend = render_backend;
+}
 
-  const uint8_t *keys = SDL_GetKeyboardState(NULL);
-  if (keys[SDL_QUIT] || key_handler == NULL) {
-    return true;
-  }
+/**
+ * Converts the keyboard state to the bitmask of keys whose presses
+ * sdl_is_done() handles. Of two opposite keys, only the first one counts.
+ */
+uint16_t get_polled_keys(const uint8_t *keys) {
+  uint16_t polled = 0;
   if (keys[SDL_SCANCODE_UP]) {
-    key_handler(UP_ARROW, KEY_PRESSED, 0, state);
+    polled |= INPUT_UP;
   } else if (keys[SDL_SCANCODE_DOWN]) {
-    key_handler(DOWN_ARROW, KEY_PRESSED, 0, state);
+    polled |= INPUT_DOWN;
   }
   if (keys[SDL_SCANCODE_LEFT]) {
-    key_handler(LEFT_ARROW, KEY_PRESSED, 0, state);
+    polled |= INPUT_LEFT;
   } else if (keys[SDL_SCANCODE_RIGHT]) {
-    key_handler(RIGHT_ARROW, KEY_PRESSED, 0, state);
+    polled |= INPUT_RIGHT;
   }
   if (keys[SDL_SCANCODE_W]) {
-    key_handler('w', KEY_PRESSED, 0, state);
+    polled |= INPUT_W;
   } else if (keys[SDL_SCANCODE_S]) {
-    key_handler('s', KEY_PRESSED, 0, state);
+    polled |= INPUT_S;
   }
   if (keys[SDL_SCANCODE_A]) {
-    key_handler('a', KEY_PRESSED, 0, state);
+    polled |= INPUT_A;
   } else if (keys[SDL_SCANCODE_D]) {
-    key_handler('d', KEY_PRESSED, 0, state);
+    polled |= INPUT_D;
   }
-
   if (keys[SDL_SCANCODE_M]) {
-    key_handler('m', KEY_PRESSED, 0, state);
+    polled |= INPUT_M;
   }
   if (keys[SDL_SCANCODE_V]) {
-    key_handler('v', KEY_PRESSED, 0, state);
+    polled |= INPUT_V;
+  }
+  return polled;
+}
+
+/** Prints how fast a finished replay ran, and whether it matched, as JSON */
+void print_replay_summary(void) {
+  double seconds = (timer_now_ns() - replay_start_ns) / (double)NS_PER_S;
+  printf("{\n");
+  printf("  \"frames\": %zu,\n", frame_index);
+  printf("  \"seconds\": %.6f,\n", seconds);
+  printf("  \"frames_per_sec\": %.1f,\n",
+         seconds > 0 ? frame_index / seconds : 0);
+  printf("  \"keyframes_checked\": %zu,\n", keyframes_checked);
+  printf("  \"keyframe_mismatches\": %zu,\n", keyframe_mismatches);
+  if (keyframe_mismatches > 0) {
+    printf("  \"first_mismatch_frame\": %zu,\n", first_mismatch_frame);
+  }
+  scene_stats_t stats = {0, 0, 0, 0, 0, 0, 0, 0, 0};
+  if (tracked_scene != NULL) {
+    stats = scene_get_stats(tracked_scene);
+  }
+  double ms_per_tick = stats.ticks > 0 ? 1e-6 / stats.ticks : 0;
+  printf("  \"ticks\": %zu,\n", stats.ticks);
+  printf("  \"pairs_tested\": %zu,\n", stats.pairs_tested);
+  printf("  \"ms_per_tick\": {\n");
+  printf("    \"broadphase\": %.4f,\n", stats.broadphase_ns * ms_per_tick);
+  printf("    \"force_creators\": %.4f,\n",
+         stats.force_creators_ns * ms_per_tick);
+  printf("    \"narrowphase\": %.4f,\n", stats.narrowphase_ns * ms_per_tick);
+  printf("    \"collision_handlers\": %.4f,\n",
+         stats.handlers_ns * ms_per_tick);
+  printf("    \"commands\": %.4f,\n", stats.commands_ns * ms_per_tick);
+  printf("    \"integration\": %.4f\n", stats.integrate_ns * ms_per_tick);
+  printf("  }\n");
+  printf("}\n");
+}
+
+void sdl_finish(void) {
+  if (replay != NULL) {
+    print_replay_summary();
+    input_log_free(replay);
+    replay = NULL;
+  }
+  if (recording != NULL) {
+    input_log_free(recording);
+    recording = NULL;
+  }
+  if (frame_stats != NULL) {
+    frame_stats_free(frame_stats);
+    frame_stats = NULL;
+  }
+}
+
+/**
+ * Handles the window's pending events, which also updates the keyboard and
+ * mouse state sdl_is_done() polls.
+ *
+ * @return whether the window was closed, or the program was asked to quit
+ *   (SDL turns SIGINT and SIGTERM into quit events)
+ */
+bool poll_quit(void) {
+  bool quit = false;
+  SDL_Event event;
+  while (SDL_PollEvent(&event)) {
+    if (event.type == SDL_QUIT) {
+      quit = true;
+    }
+  }
+  return quit;
+}
+
+bool sdl_is_done(void *state) {
+  input_frame_t frame = {frame_dt_ns, 0, false, 0, 0};
+  // a replay's window must still respond, and can be closed early
+  if (poll_quit()) {
+    sdl_finish();
+    return true;
+  }
+  if (replay != NULL) {
+    if (frame_index == input_log_num_frames(replay)) {
+      sdl_finish();
+      return true;
+    }
+    frame = input_log_get_frame(replay, frame_index);
+  } else {
+    if (key_handler == NULL) {
+      sdl_finish();
+      return true;
+    }
+    int x = 0, y = 0;
+    uint32_t bitmask = SDL_GetMouseState(&x, &y);
+    if (bitmask > 0 && SDL_BUTTON(bitmask) == 1) {
+      frame.clicked = true;
+      frame.click_x = x;
+      frame.click_y = y;
+    } else {
+      const uint8_t *keys = SDL_GetKeyboardState(NULL);
+      frame.keys = get_polled_keys(keys);
+    }
+    if (recording != NULL) {
+      input_log_add_frame(recording, frame);
+    }
+  }
+  frame_index++;
+
+  if (frame.clicked) {
+    asset_cache_handle_buttons(state, (double)frame.click_x,
+                               (double)frame.click_y);
+    return false;
+  }
+  if (key_handler == NULL) {
+    sdl_finish();
+    return true;
+  }
+  for (size_t i = 0; i < NUM_POLLED_KEYS; i++) {
+    if (frame.keys & POLLED_KEYS[i].bit) {
+      key_handler(POLLED_KEYS[i].key, KEY_PRESSED, 0, state);
+    }
   }
   return false;
 }
 
+/**
+ * Orders queued sprites by layer, then by texture, then by when they were
+ * rendered, so that each layer's sprites of one texture are adjacent.
+ */
+static int compare_queued_sprites(const void *a, const void *b) {
+  const queued_sprite_t *sprite_a = a, *sprite_b = b;
+  if (sprite_a->layer != sprite_b->layer) {
+    return sprite_a->layer < sprite_b->layer ? -1 : 1;
+  }
+  uintptr_t texture_a = (uintptr_t)sprite_a->texture,
+            texture_b = (uintptr_t)sprite_b->texture;
+  if (texture_a != texture_b) {
+    return texture_a < texture_b ? -1 : 1;
+  }
+  return (sprite_a->order > sprite_b->order) -
+         (sprite_a->order < sprite_b->order);
+}
+
+static void reset_sprites(void) {
+  num_queued_sprites = 0;
+  sprite_layer = 0;
+  last_sprite_texture = NULL;
+  last_sprite_reorderable = false;
+}
+
+/**
+ * Draws the queued sprites, one backend call per run of sprites that share
+ * a layer and a texture. Called before anything else is drawn, so that
+ * sprites stay under whatever is drawn after them.
+ */
+static void flush_sprites(void) {
+  if (num_queued_sprites == 0) {
+    return;
+  }
+  qsort(queued_sprites, num_queued_sprites, sizeof(queued_sprite_t),
+        compare_queued_sprites);
+  size_t start = 0;
+  while (start < num_queued_sprites) {
+    queued_sprite_t *first = &queued_sprites[start];
+    size_t n = 0;
+    while (start + n < num_queued_sprites &&
+           queued_sprites[start + n].layer == first->layer &&
+           queued_sprites[start + n].texture == first->texture) {
+      sprite_quads[n] = queued_sprites[start + n].quad;
+      n++;
+    }
+    backend->render_sprites(first->texture, sprite_quads, n);
+    start += n;
+  }
+  reset_sprites();
+}
+
+/**
+ * Draws the triangles of the queued polygons in one backend call.
+ * Called before anything else is drawn, so that polygons stay under
+ * whatever is drawn after them.
+ */
+static void flush_polygons(void) {
+  if (num_polygon_indices > 0) {
+    backend->draw_triangles(polygon_vertices, num_polygon_vertices,
+                            polygon_indices, num_polygon_indices);
+  }
+  num_polygon_vertices = 0;
+  num_polygon_indices = 0;
+}
+
+/**
+ * Draws everything queued, before drawing something that isn't queued.
+ * At most one of the queues is non-empty, since each flushes the other.
+ */
+static void flush_draws(void) {
+  flush_polygons();
+  flush_sprites();
+}
+
+/**
+ * Makes room for a polygon with n vertices in the polygon queue.
+ * A polygon has n - 2 triangles, so fewer than 3 indices per vertex.
+ */
+static void reserve_polygon_vertices(size_t n) {
+  size_t needed = num_polygon_vertices + n;
+  if (needed <= polygon_vertex_capacity) {
+    return;
+  }
+  size_t capacity = polygon_vertex_capacity ? polygon_vertex_capacity
+                                            : INITIAL_NUM_POLYGON_VERTICES;
+  while (capacity < needed) {
+    capacity *= 2;
+  }
+  polygon_vertices =
+      realloc(polygon_vertices, sizeof(SDL_Vertex) * capacity);
+  polygon_indices = realloc(polygon_indices, sizeof(int) * 3 * capacity);
+  assert(polygon_vertices && polygon_indices);
+  polygon_vertex_capacity = capacity;
+}
+
 void sdl_clear(void) {
-  SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
-  SDL_RenderClear(renderer);
+  // anything drawn since the last frame was shown would be cleared anyway
+  reset_sprites();
+  num_polygon_vertices = 0;
+  num_polygon_indices = 0;
+  backend->clear(WHITE);
 }
 
-void sdl_draw_polygon(polygon_t *poly, rgb_color_t *color) {
-  list_t *points = polygon_get_points(poly);
+/**
+ * Queues a polygon's triangles, translated by an offset in the scene.
+ */
+static void queue_polygon(polygon_t *poly, rgb_color_t *color,
+                          vector_t translation) {
+  flush_sprites();
   // Check parameters
-  size_t n = list_size(points);
+  size_t n = polygon_num_vertices(poly);
   assert(n >= 3);
   assert(0 <= color->r && color->r <= 1);
   assert(0 <= color->g && color->g <= 1);
   assert(0 <= color->b && color->b <= 1);
+  reserve_polygon_vertices(n);
 
+  // Map the scene to the window as get_window_position() does, flipping
+  // the y axis since positive y is down on the screen
   vector_t window_center = get_window_center();
-
-  // Convert each vertex to a point on screen
-  int16_t *x_points = malloc(sizeof(*x_points) * n),
-          *y_points = malloc(sizeof(*y_points) * n);
-  assert(x_points);
-  assert(y_points);
+  double scale = get_scene_scale(window_center);
+  SDL_Color sdl_color = {color->r * 255, color->g * 255, color->b * 255, 255};
+  const vector_t *vertices = polygon_get_vertices(poly);
+  SDL_Vertex *pixels = &polygon_vertices[num_polygon_vertices];
+  vector_t origin = vec_subtract(center, translation);
   for (size_t i = 0; i < n; i++) {
-    vector_t *vertex = list_get(points, i);
-    vector_t pixel = get_window_position(*vertex, window_center);
-    x_points[i] = pixel.x;
-    y_points[i] = pixel.y;
+    vector_t offset = vec_subtract(vertices[i], origin);
+    pixels[i] = (SDL_Vertex){
+        .position = {window_center.x + scale * offset.x,
+                     window_center.y - scale * offset.y},
+        .color = sdl_color};
   }
 
-  // Draw polygon with the given color
-  filledPolygonRGBA(renderer, x_points, y_points, n, color->r * 255,
-                    color->g * 255, color->b * 255, 255);
-  free(x_points);
-  free(y_points);
+  // The shape's triangles, renumbered to the polygon's place in the queue
+  const int *triangles = shape_get_triangles(polygon_get_shape(poly));
+  size_t num_indices = 3 * (n - 2);
+  int first = num_polygon_vertices;
+  int *indices = &polygon_indices[num_polygon_indices];
+  for (size_t i = 0; i < num_indices; i++) {
+    indices[i] = first + triangles[i];
+  }
+  num_polygon_vertices += n;
+  num_polygon_indices += num_indices;
+}
+
+void sdl_draw_polygon(polygon_t *poly, rgb_color_t *color) {
+  queue_polygon(poly, color, VEC_ZERO);
+}
+
+void sdl_draw_body(body_t *body) {
+  // only a body's position is interpolated: its polygon only turns when
+  // body_set_rotation() is called, which skips the interpolation
+  vector_t translation =
+      vec_subtract(body_get_interpolated_centroid(body, render_alpha),
+                   body_get_centroid(body));
+  queue_polygon(body_get_polygon(body), body_get_color(body), translation);
 }
 
 void sdl_show(void) {
+  flush_draws();
   // Draw boundary lines
   vector_t window_center = get_window_center();
   vector_t max = vec_add(center, max_diff),
            min = vec_subtract(center, max_diff);
   vector_t max_pixel = get_window_position(max, window_center),
            min_pixel = get_window_position(min, window_center);
-  SDL_Rect *boundary = malloc(sizeof(*boundary));
-  boundary->x = min_pixel.x;
-  boundary->y = max_pixel.y;
-  boundary->w = max_pixel.x - min_pixel.x;
-  boundary->h = min_pixel.y - max_pixel.y;
-  SDL_SetRenderDrawColor(renderer, BLACK.r, BLACK.g, BLACK.b, 255);
-  SDL_RenderDrawRect(renderer, boundary);
-  free(boundary);
+  SDL_Rect boundary = {min_pixel.x, max_pixel.y, max_pixel.x - min_pixel.x,
+                       min_pixel.y - max_pixel.y};
+  backend->draw_rect(boundary, BLACK);
 
-  SDL_RenderPresent(renderer);
+  backend->present();
 }
 
 void sdl_render_scene(scene_t *scene, void *aux) {
   sdl_clear();
   size_t body_count = scene_bodies(scene);
   for (size_t i = 0; i < body_count; i++) {
-    body_t *body = scene_get_body(scene, i);
-    list_t *shape = body_get_shape(body);
-    polygon_t *poly = polygon_init(shape, (vector_t){0, 0}, 0, 0, 0, 0);
-    sdl_draw_polygon(poly, body_get_color(body));
-    list_free(shape);
+    sdl_draw_body(scene_get_body(scene, i));
   }
   if (aux != NULL) {
-    body_t *body = aux;
-    sdl_draw_polygon(body_get_polygon(body), body_get_color(body));
+    sdl_draw_body(aux);
   }
   sdl_show();
 }
@@ -245,45 +557,103 @@ void sdl_on_key(key_handler_t handler) { key_handler = handler; }
 void sdl_on_click(mouse_handler_t handler) { mouse_handler = handler; }
 
 double time_since_last_tick(void) {
-  clock_t now = clock();
-  double difference = last_clock
-                          ? (double)(now - last_clock) / CLOCKS_PER_SEC
-                          : 0.0; // return 0 the first time this is called
-  last_clock = now;
-  return difference;
+  uint64_t now = timer_now_ns();
+  uint64_t difference = 0; // return 0 the first time this is called
+  if (last_tick_ns) {
+    difference = now - last_tick_ns;
+    frame_stats_add(sdl_get_frame_stats(), difference / (double)NS_PER_S);
+  }
+  last_tick_ns = now;
+  // whole nanoseconds that fit in a recording, so replays get the same value
+  frame_dt_ns = difference < UINT32_MAX ? difference : UINT32_MAX;
+  if (replay != NULL && frame_index < input_log_num_frames(replay)) {
+    frame_dt_ns = input_log_get_frame(replay, frame_index).dt_ns;
+  }
+  return frame_dt_ns / (double)NS_PER_S;
 }
 
-SDL_Rect sdl_get_bounding_box(body_t *body) {
-  vector_t maxes = (vector_t){-__DBL_MAX__, -__DBL_MAX__};
-  vector_t mins = (vector_t){__DBL_MAX__, __DBL_MAX__};
-  list_t *vertices = body_get_shape(body);
-  size_t n = list_size(vertices);
+frame_stats_t *sdl_get_frame_stats(void) {
+  if (frame_stats == NULL) {
+    frame_stats = frame_stats_init(FRAME_HISTORY);
+  }
+  return frame_stats;
+}
 
-  vector_t window_center = get_window_center();
+uint32_t sdl_get_seed(void) {
+  if (!has_seed) {
+    seed = time(NULL);
+    has_seed = true;
+  }
+  return seed;
+}
 
-  for (size_t i = 0; i < n; i++) {
-    vector_t *vec = list_get(vertices, i);
-    assert(vec);
-    vector_t pixel = get_window_position(*vec, window_center);
-    if (maxes.x < pixel.x) {
-      maxes.x = pixel.x;
-    }
-    if (mins.x > pixel.x) {
-      mins.x = pixel.x;
-    }
-    if (maxes.y < pixel.y) {
-      maxes.y = pixel.y;
-    }
-    if (mins.y > pixel.y) {
-      mins.y = pixel.y;
+bool sdl_record_input(const char *path) {
+  assert(recording == NULL && replay == NULL);
+  recording = input_log_record(path, sdl_get_seed(), KEYFRAME_INTERVAL);
+  return recording != NULL;
+}
+
+bool sdl_replay_input(const char *path) {
+  assert(recording == NULL && replay == NULL);
+  replay = input_log_load(path);
+  if (replay == NULL) {
+    return false;
+  }
+  seed = input_log_get_seed(replay);
+  has_seed = true;
+  replay_start_ns = timer_now_ns();
+  return true;
+}
+
+void sdl_track_scene(scene_t *scene) {
+  tracked_scene = scene;
+  input_log_t *log = recording != NULL ? recording : replay;
+  if (log == NULL || frame_index % input_log_get_keyframe_interval(log) != 0) {
+    return;
+  }
+  keyframe_t keyframe = {frame_index, scene_bodies(scene),
+                         scene_digest(scene)};
+  if (recording != NULL) {
+    input_log_add_keyframe(recording, keyframe);
+    return;
+  }
+  keyframe_t expected;
+  if (!input_log_get_keyframe(replay, frame_index, &expected)) {
+    return;
+  }
+  keyframes_checked++;
+  if (expected.num_bodies != keyframe.num_bodies ||
+      expected.digest != keyframe.digest) {
+    if (keyframe_mismatches == 0) {
+      first_mismatch_frame = frame_index;
     }
+    keyframe_mismatches++;
   }
+}
+
+void sdl_set_interpolation(double alpha) { render_alpha = alpha; }
+
+double sdl_get_interpolation(void) { return render_alpha; }
 
-  list_free(vertices);
-  double x = mins.x;
-  double y = mins.y;
-  double w = maxes.x - mins.x;
-  double h = maxes.y - mins.y;
+SDL_Rect sdl_get_bounding_box(body_t *body) {
+  polygon_t *poly = body_get_polygon(body);
+  vector_t window_center = get_window_center();
+  vector_t offset =
+      vec_subtract(body_get_interpolated_centroid(body, render_alpha),
+                   body_get_centroid(body));
+  vector_t min = vec_add(polygon_get_bounds_min(poly), offset);
+  vector_t max = vec_add(polygon_get_bounds_max(poly), offset);
+  // the y axis is flipped on screen, so the top-left pixel comes from
+  // the minimum x and the maximum y
+  vector_t top_left = get_window_position((vector_t){min.x, max.y},
+                                          window_center);
+  vector_t bottom_right = get_window_position((vector_t){max.x, min.y},
+                                              window_center);
+
+  double x = top_left.x;
+  double y = top_left.y;
+  double w = bottom_right.x - top_left.x;
+  double h = bottom_right.y - top_left.y;
 
   SDL_Rect rect = (SDL_Rect){x, y, w, h};
   return rect;
@@ -293,24 +663,65 @@ SDL_Texture *sdl_load_text_texture(TTF_Font *font, const char *msg,
                                    rgb_color_t color) {
   SDL_Color sdl_color =
       (SDL_Color){(uint8_t)color.r, (uint8_t)color.g, (uint8_t)color.b};
-  SDL_Surface *message = TTF_RenderText_Blended(font, msg, sdl_color);
-  assert(message);
-  SDL_Texture *texture = SDL_CreateTextureFromSurface(renderer, message);
-  SDL_FreeSurface(message);
-  return texture;
+  return backend->load_text_texture(font, msg, sdl_color);
 }
 
 SDL_Texture *sdl_load_img_texture(const char *IMG_PATH) {
-  SDL_Texture *texture = IMG_LoadTexture(renderer, IMG_PATH);
-  return texture;
+  return backend->load_img_texture(IMG_PATH);
+}
+
+SDL_Surface *sdl_load_img_surface(const char *IMG_PATH) {
+  return backend->load_img_surface(IMG_PATH);
+}
+
+SDL_Texture *sdl_load_surface_texture(SDL_Surface *surface) {
+  return backend->load_surface_texture(surface);
+}
+
+void sdl_destroy_texture(SDL_Texture *texture) {
+  backend->destroy_texture(texture);
 }
 
 void sdl_render_texture(SDL_Texture *texture, SDL_Rect bounding_box) {
-  SDL_RenderCopy(renderer, texture, NULL, &bounding_box);
+  flush_draws();
+  backend->render_texture(texture, NULL, bounding_box, 0);
 }
 
 void sdl_render_rotate_texture(SDL_Texture *texture, SDL_Rect bounding_box,
                                double angle) {
-  SDL_RenderCopyEx(renderer, texture, NULL, &bounding_box, 180 * angle / M_PI,
-                   NULL, SDL_FLIP_NONE);
+  flush_draws();
+  backend->render_texture(texture, NULL, bounding_box, angle);
+}
+
+void sdl_render_sprite(sprite_t sprite, SDL_Rect bounding_box, double angle,
+                       bool reorderable) {
+  flush_polygons();
+  if (num_queued_sprites == sprite_capacity) {
+    sprite_capacity =
+        sprite_capacity ? sprite_capacity * 2 : INITIAL_NUM_SPRITES;
+    queued_sprites =
+        realloc(queued_sprites, sizeof(queued_sprite_t) * sprite_capacity);
+    sprite_quads =
+        realloc(sprite_quads, sizeof(sprite_quad_t) * sprite_capacity);
+    assert(queued_sprites && sprite_quads);
+  }
+  if (reorderable != last_sprite_reorderable ||
+      (!reorderable && sprite.texture != last_sprite_texture)) {
+    sprite_layer++;
+  }
+  last_sprite_texture = sprite.texture;
+  last_sprite_reorderable = reorderable;
+  queued_sprites[num_queued_sprites] =
+      (queued_sprite_t){sprite_layer, num_queued_sprites, sprite.texture,
+                        (sprite_quad_t){sprite.region, bounding_box, angle}};
+  num_queued_sprites++;
+}
+
+void sdl_render_texture_regions(SDL_Texture *texture, const SDL_Rect *src,
+                                const SDL_Rect *dst, size_t n,
+                                rgb_color_t color) {
+  flush_draws();
+  SDL_Color sdl_color =
+      (SDL_Color){(uint8_t)color.r, (uint8_t)color.g, (uint8_t)color.b};
+  backend->render_texture_regions(texture, src, dst, n, sdl_color);
 }
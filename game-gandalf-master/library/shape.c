@@ -0,0 +1,177 @@
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+
+#include "shape.h"
+
+static list_t *SHAPE_REGISTRY;
+
+const size_t INITIAL_NUM_SHAPES = 8;
+
+typedef enum { SHAPE_CUSTOM, SHAPE_REGULAR, SHAPE_RECTANGLE } shape_kind_t;
+
+struct shape {
+  // what the shape was registered as, to find it again
+  shape_kind_t kind;
+  size_t num_points;
+  vector_t size;
+
+  size_t num_vertices;
+  double area;
+  double radius;
+  vector_t centroid_offset;
+  vector_t *normals;
+  // indices of the vertices of each triangle the shape is split into
+  int *triangles;
+  // num_vertices vertices followed by num_vertices normals, then triangles
+  vector_t data[];
+};
+
+/**
+ * Allocates a shape and precomputes its properties from a convex polygon.
+ *
+ * @param vertices the vertices of the polygon, in counterclockwise order
+ * @param num_vertices the number of vertices
+ * @return a pointer to the new shape
+ */
+static shape_t *shape_from_vertices(const vector_t *vertices,
+                                    size_t num_vertices) {
+  assert(num_vertices >= 3);
+  size_t num_triangles = num_vertices - 2;
+  shape_t *shape = malloc(sizeof(shape_t) +
+                          2 * num_vertices * sizeof(vector_t) +
+                          3 * num_triangles * sizeof(int));
+  assert(shape);
+  shape->kind = SHAPE_CUSTOM;
+  shape->num_points = num_vertices;
+  shape->size = VEC_ZERO;
+  shape->num_vertices = num_vertices;
+  shape->normals = shape->data + num_vertices;
+  shape->triangles = (int *)(shape->data + 2 * num_vertices);
+
+  // a convex polygon is a fan of triangles around any of its vertices
+  for (size_t i = 0; i < num_triangles; i++) {
+    shape->triangles[3 * i] = 0;
+    shape->triangles[3 * i + 1] = i + 1;
+    shape->triangles[3 * i + 2] = i + 2;
+  }
+
+  // Shoelace Theorem and the centroid of a polygon, see
+  // https://en.wikipedia.org/wiki/Centroid#Of_a_polygon
+  double signed_area = 0;
+  vector_t centroid = VEC_ZERO;
+  for (size_t i = 0; i < num_vertices; i++) {
+    vector_t v_i = vertices[i];
+    vector_t v_i_plus = vertices[(i + 1) % num_vertices];
+    double cross = v_i.x * v_i_plus.y - v_i.y * v_i_plus.x;
+    signed_area += cross;
+    centroid.x += (v_i.x + v_i_plus.x) * cross;
+    centroid.y += (v_i.y + v_i_plus.y) * cross;
+  }
+  signed_area *= 0.5;
+  centroid = vec_multiply(1.0 / (6 * signed_area), centroid);
+  shape->area = fabs(signed_area);
+  shape->centroid_offset = centroid;
+
+  double radius_squared = 0;
+  for (size_t i = 0; i < num_vertices; i++) {
+    vector_t local = vec_subtract(vertices[i], centroid);
+    shape->data[i] = local;
+    radius_squared = fmax(radius_squared, vec_dot(local, local));
+  }
+  shape->radius = sqrt(radius_squared);
+
+  for (size_t i = 0; i < num_vertices; i++) {
+    vector_t edge = vec_subtract(vertices[i], vertices[(i + 1) % num_vertices]);
+    // the edge rotated by a quarter turn
+    vector_t normal = {-edge.y, edge.x};
+    shape->normals[i] = vec_multiply(1.0 / vec_get_length(normal), normal);
+  }
+  return shape;
+}
+
+void shape_registry_init() {
+  SHAPE_REGISTRY = list_init(INITIAL_NUM_SHAPES, (free_func_t)shape_free);
+}
+
+void shape_registry_destroy() { list_free(SHAPE_REGISTRY); }
+
+static shape_t *shape_registry_find(shape_kind_t kind, size_t num_points,
+                                    vector_t size) {
+  for (size_t i = 0; i < list_size(SHAPE_REGISTRY); i++) {
+    shape_t *shape = list_get(SHAPE_REGISTRY, i);
+    if (shape->kind == kind && shape->num_points == num_points &&
+        shape->size.x == size.x && shape->size.y == size.y) {
+      return shape;
+    }
+  }
+  return NULL;
+}
+
+static void shape_registry_add(shape_t *shape, shape_kind_t kind,
+                               size_t num_points, vector_t size) {
+  shape->kind = kind;
+  shape->num_points = num_points;
+  shape->size = size;
+  list_add(SHAPE_REGISTRY, shape);
+}
+
+shape_t *shape_get_regular_polygon(size_t num_points, double radius) {
+  vector_t size = {radius, radius};
+  shape_t *shape = shape_registry_find(SHAPE_REGULAR, num_points, size);
+  if (shape) {
+    return shape;
+  }
+  vector_t *vertices = malloc(sizeof(vector_t) * num_points);
+  assert(vertices);
+  for (size_t i = 0; i < num_points; i++) {
+    double angle = 2 * M_PI * i / num_points;
+    vertices[i] = (vector_t){radius * cos(angle), radius * sin(angle)};
+  }
+  shape = shape_from_vertices(vertices, num_points);
+  free(vertices);
+  shape_registry_add(shape, SHAPE_REGULAR, num_points, size);
+  return shape;
+}
+
+shape_t *shape_get_rectangle(double width, double height) {
+  vector_t size = {width, height};
+  shape_t *shape = shape_registry_find(SHAPE_RECTANGLE, 4, size);
+  if (shape) {
+    return shape;
+  }
+  vector_t vertices[] = {{0, 0}, {width, 0}, {width, height}, {0, height}};
+  shape = shape_from_vertices(vertices, 4);
+  shape_registry_add(shape, SHAPE_RECTANGLE, 4, size);
+  return shape;
+}
+
+shape_t *shape_init(list_t *points) {
+  size_t num_vertices = list_size(points);
+  vector_t *vertices = malloc(sizeof(vector_t) * num_vertices);
+  assert(vertices);
+  for (size_t i = 0; i < num_vertices; i++) {
+    vertices[i] = *(vector_t *)list_get(points, i);
+  }
+  shape_t *shape = shape_from_vertices(vertices, num_vertices);
+  free(vertices);
+  return shape;
+}
+
+void shape_free(shape_t *shape) { free(shape); }
+
+size_t shape_num_vertices(shape_t *shape) { return shape->num_vertices; }
+
+const vector_t *shape_get_vertices(shape_t *shape) { return shape->data; }
+
+const vector_t *shape_get_normals(shape_t *shape) { return shape->normals; }
+
+const int *shape_get_triangles(shape_t *shape) { return shape->triangles; }
+
+double shape_get_area(shape_t *shape) { return shape->area; }
+
+vector_t shape_get_centroid_offset(shape_t *shape) {
+  return shape->centroid_offset;
+}
+
+double shape_get_radius(shape_t *shape) { return shape->radius; }
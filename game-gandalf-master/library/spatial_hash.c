@@ -0,0 +1,212 @@
+#include <assert.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "spatial_hash.h"
+
+const size_t SPATIAL_HASH_INITIAL_CAPACITY = 64;
+
+typedef struct {
+  body_t *body;
+  vector_t min;
+  vector_t max;
+} grid_item_t;
+
+typedef struct {
+  uint64_t cell;
+  size_t item;
+} cell_entry_t;
+
+typedef struct {
+  size_t item1;
+  size_t item2;
+} item_pair_t;
+
+struct spatial_hash {
+  double cell_size;
+
+  grid_item_t *items;
+  size_t num_items;
+  size_t item_capacity;
+
+  cell_entry_t *entries;
+  size_t num_entries;
+  size_t entry_capacity;
+
+  item_pair_t *pairs;
+  size_t num_pairs;
+  size_t pair_capacity;
+
+  // the candidate pairs again, for spatial_hash_has_pair()
+  pair_set_t *lookup;
+};
+
+spatial_hash_t *spatial_hash_init(double cell_size) {
+  assert(cell_size > 0);
+  spatial_hash_t *hash = malloc(sizeof(spatial_hash_t));
+  assert(hash);
+
+  hash->cell_size = cell_size;
+
+  hash->items = malloc(sizeof(grid_item_t) * SPATIAL_HASH_INITIAL_CAPACITY);
+  assert(hash->items);
+  hash->num_items = 0;
+  hash->item_capacity = SPATIAL_HASH_INITIAL_CAPACITY;
+
+  hash->entries = malloc(sizeof(cell_entry_t) * SPATIAL_HASH_INITIAL_CAPACITY);
+  assert(hash->entries);
+  hash->num_entries = 0;
+  hash->entry_capacity = SPATIAL_HASH_INITIAL_CAPACITY;
+
+  hash->pairs = malloc(sizeof(item_pair_t) * SPATIAL_HASH_INITIAL_CAPACITY);
+  assert(hash->pairs);
+  hash->num_pairs = 0;
+  hash->pair_capacity = SPATIAL_HASH_INITIAL_CAPACITY;
+
+  hash->lookup = pair_set_init();
+  return hash;
+}
+
+void spatial_hash_free(spatial_hash_t *hash) {
+  free(hash->items);
+  free(hash->entries);
+  free(hash->pairs);
+  pair_set_free(hash->lookup);
+  free(hash);
+}
+
+void spatial_hash_clear(spatial_hash_t *hash) {
+  hash->num_items = 0;
+  hash->num_entries = 0;
+  hash->num_pairs = 0;
+}
+
+/**
+ * Doubles the capacity of an array until it can hold `needed` elements.
+ *
+ * @param data the array to grow
+ * @param capacity the current capacity of the array, updated in place
+ * @param needed the number of elements the array must be able to hold
+ * @param elem_size the size of each element
+ */
+static void *grow_array(void *data, size_t *capacity, size_t needed,
+                        size_t elem_size) {
+  if (needed <= *capacity) {
+    return data;
+  }
+  size_t new_capacity = *capacity;
+  while (new_capacity < needed) {
+    new_capacity *= 2;
+  }
+  void *new_data = realloc(data, new_capacity * elem_size);
+  assert(new_data);
+  *capacity = new_capacity;
+  return new_data;
+}
+
+/** Packs integer cell coordinates into a single sortable key */
+static uint64_t cell_key(int64_t x, int64_t y) {
+  return ((uint64_t)(uint32_t)x << 32) | (uint64_t)(uint32_t)y;
+}
+
+static int64_t cell_coord(spatial_hash_t *hash, double pos) {
+  return (int64_t)floor(pos / hash->cell_size);
+}
+
+void spatial_hash_insert(spatial_hash_t *hash, body_t *body) {
+  polygon_t *polygon = body_get_polygon(body);
+  vector_t min = polygon_get_bounds_min(polygon);
+  vector_t max = polygon_get_bounds_max(polygon);
+
+  hash->items = grow_array(hash->items, &hash->item_capacity,
+                           hash->num_items + 1, sizeof(grid_item_t));
+  size_t item = hash->num_items++;
+  hash->items[item] = (grid_item_t){body, min, max};
+
+  int64_t min_x = cell_coord(hash, min.x), max_x = cell_coord(hash, max.x);
+  int64_t min_y = cell_coord(hash, min.y), max_y = cell_coord(hash, max.y);
+  size_t num_cells = (max_x - min_x + 1) * (max_y - min_y + 1);
+  hash->entries =
+      grow_array(hash->entries, &hash->entry_capacity,
+                 hash->num_entries + num_cells, sizeof(cell_entry_t));
+  for (int64_t x = min_x; x <= max_x; x++) {
+    for (int64_t y = min_y; y <= max_y; y++) {
+      hash->entries[hash->num_entries++] = (cell_entry_t){cell_key(x, y), item};
+    }
+  }
+}
+
+static int compare_entries(const void *a, const void *b) {
+  const cell_entry_t *entry1 = a, *entry2 = b;
+  if (entry1->cell != entry2->cell) {
+    return entry1->cell < entry2->cell ? -1 : 1;
+  }
+  if (entry1->item != entry2->item) {
+    return entry1->item < entry2->item ? -1 : 1;
+  }
+  return 0;
+}
+
+static bool items_overlap(grid_item_t *item1, grid_item_t *item2) {
+  return item1->min.x <= item2->max.x && item2->min.x <= item1->max.x &&
+         item1->min.y <= item2->max.y && item2->min.y <= item1->max.y;
+}
+
+/**
+ * Two overlapping boxes can share several cells.
+ * The pair is only reported from the cell containing the corner where their
+ * overlap begins, so no deduplication pass is needed.
+ */
+static bool owns_pair(spatial_hash_t *hash, uint64_t cell,
+                      grid_item_t *item1, grid_item_t *item2) {
+  double x = fmax(item1->min.x, item2->min.x);
+  double y = fmax(item1->min.y, item2->min.y);
+  return cell == cell_key(cell_coord(hash, x), cell_coord(hash, y));
+}
+
+void spatial_hash_build_pairs(spatial_hash_t *hash) {
+  hash->num_pairs = 0;
+  pair_set_clear(hash->lookup);
+  qsort(hash->entries, hash->num_entries, sizeof(cell_entry_t),
+        compare_entries);
+
+  size_t start = 0;
+  while (start < hash->num_entries) {
+    uint64_t cell = hash->entries[start].cell;
+    size_t end = start + 1;
+    while (end < hash->num_entries && hash->entries[end].cell == cell) {
+      end++;
+    }
+    for (size_t i = start; i < end; i++) {
+      size_t item1 = hash->entries[i].item;
+      for (size_t j = i + 1; j < end; j++) {
+        size_t item2 = hash->entries[j].item;
+        grid_item_t *grid_item1 = &hash->items[item1];
+        grid_item_t *grid_item2 = &hash->items[item2];
+        if (!items_overlap(grid_item1, grid_item2) ||
+            !owns_pair(hash, cell, grid_item1, grid_item2)) {
+          continue;
+        }
+        hash->pairs = grow_array(hash->pairs, &hash->pair_capacity,
+                                 hash->num_pairs + 1, sizeof(item_pair_t));
+        hash->pairs[hash->num_pairs++] = (item_pair_t){item1, item2};
+        pair_set_add(hash->lookup, grid_item1->body, grid_item2->body);
+      }
+    }
+    start = end;
+  }
+}
+
+size_t spatial_hash_num_pairs(spatial_hash_t *hash) { return hash->num_pairs; }
+
+body_pair_t spatial_hash_get_pair(spatial_hash_t *hash, size_t index) {
+  assert(index < hash->num_pairs);
+  item_pair_t pair = hash->pairs[index];
+  return (body_pair_t){hash->items[pair.item1].body,
+                       hash->items[pair.item2].body};
+}
+
+bool spatial_hash_has_pair(spatial_hash_t *hash, body_t *body1, body_t *body2) {
+  return pair_set_contains(hash->lookup, body1, body2);
+}
@@ -0,0 +1,54 @@
+#include <assert.h>
+#include <stdlib.h>
+
+#include "atlas_pack.h"
+#include "sdl_wrapper.h"
+#include "sprite_atlas.h"
+
+struct sprite_atlas {
+  sprite_t *sprites;
+  size_t num_sprites;
+  SDL_Texture **pages;
+  size_t num_pages;
+};
+
+sprite_atlas_t *sprite_atlas_build(const char **paths, size_t num_paths) {
+  sprite_atlas_t *atlas = malloc(sizeof(sprite_atlas_t));
+  assert(atlas);
+  atlas->sprites = malloc(sizeof(sprite_t) * (num_paths + 1));
+  SDL_Surface **images = malloc(sizeof(SDL_Surface *) * (num_paths + 1));
+  assert(atlas->sprites && images);
+  atlas->num_sprites = num_paths;
+  for (size_t i = 0; i < num_paths; i++) {
+    images[i] = sdl_load_img_surface(paths[i]);
+  }
+  atlas->pages =
+      atlas_pack_images(images, num_paths, atlas->sprites, &atlas->num_pages);
+  free(images);
+  return atlas;
+}
+
+size_t sprite_atlas_num_sprites(sprite_atlas_t *atlas) {
+  return atlas->num_sprites;
+}
+
+size_t sprite_atlas_num_pages(sprite_atlas_t *atlas) {
+  return atlas->num_pages;
+}
+
+sprite_t sprite_atlas_get(sprite_atlas_t *atlas, size_t index) {
+  assert(index < atlas->num_sprites);
+  return atlas->sprites[index];
+}
+
+void sprite_atlas_free(sprite_atlas_t *atlas) {
+  if (atlas == NULL) {
+    return;
+  }
+  for (size_t page = 0; page < atlas->num_pages; page++) {
+    sdl_destroy_texture(atlas->pages[page]);
+  }
+  free(atlas->pages);
+  free(atlas->sprites);
+  free(atlas);
+}
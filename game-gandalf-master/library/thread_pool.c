@@ -0,0 +1,445 @@
+#include <assert.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "thread_pool.h"
+
+#ifdef USE_PTHREADS
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+const size_t INITIAL_DEQUE_CAPACITY = 64;
+const size_t INITIAL_NUM_DEPENDENTS = 2;
+// thread_pool_parallel_for() makes up to this many chunks per thread, so
+// threads that finish early can steal the rest
+const size_t CHUNKS_PER_THREAD = 4;
+
+struct task {
+  job_func_t job;
+  void *aux;
+  size_t index;
+
+  // dependencies that haven't finished, plus 1 until the task is submitted
+  atomic_size_t unmet;
+  bool submitted;
+  atomic_bool finished;
+  // tasks that depend on this one; fixed once this one is submitted
+  task_t **dependents;
+  size_t num_dependents;
+  size_t dependent_capacity;
+};
+
+/**
+ * A double-ended queue of ready tasks belonging to one thread.
+ * The owner pushes and pops at the bottom, other threads steal from the top.
+ * Positions only grow; the task at position i is at tasks[i % capacity].
+ */
+typedef struct task_deque {
+  task_t **tasks;
+  size_t capacity;
+  size_t top;
+  size_t bottom;
+#ifdef USE_PTHREADS
+  pthread_mutex_t lock;
+#endif
+} task_deque_t;
+
+#ifdef USE_PTHREADS
+typedef struct worker {
+  pthread_t thread;
+  thread_pool_t *pool;
+  size_t index;
+} worker_t;
+#endif
+
+struct thread_pool {
+  size_t num_threads;
+  // one per thread; deque 0 belongs to the threads outside the pool
+  task_deque_t *deques;
+  // the number of tasks in all the deques
+  atomic_size_t num_ready;
+  // the tasks of a thread_pool_run() batch, reused from call to call;
+  // a batch that starts while another one is running allocates its own
+  task_t *batch;
+  size_t batch_capacity;
+  atomic_bool batch_busy;
+#ifdef USE_PTHREADS
+  worker_t *workers;
+  // idle workers sleep on `work_ready` until a task is pushed
+  pthread_mutex_t sleep_lock;
+  pthread_cond_t work_ready;
+  bool stopping;
+#endif
+};
+
+typedef struct parallel_for_aux {
+  range_func_t func;
+  void *aux;
+  size_t start;
+  size_t end;
+  size_t num_chunks;
+} parallel_for_aux_t;
+
+// the pool the current thread works for, and its deque in that pool
+static _Thread_local thread_pool_t *current_pool = NULL;
+static _Thread_local size_t current_deque = 0;
+
+static void deque_init(task_deque_t *deque) {
+  deque->tasks = malloc(sizeof(task_t *) * INITIAL_DEQUE_CAPACITY);
+  assert(deque->tasks);
+  deque->capacity = INITIAL_DEQUE_CAPACITY;
+  deque->top = 0;
+  deque->bottom = 0;
+#ifdef USE_PTHREADS
+  pthread_mutex_init(&deque->lock, NULL);
+#endif
+}
+
+static void deque_free(task_deque_t *deque) {
+  assert(deque->top == deque->bottom);
+#ifdef USE_PTHREADS
+  pthread_mutex_destroy(&deque->lock);
+#endif
+  free(deque->tasks);
+}
+
+static void deque_lock(task_deque_t *deque) {
+#ifdef USE_PTHREADS
+  pthread_mutex_lock(&deque->lock);
+#endif
+}
+
+static void deque_unlock(task_deque_t *deque) {
+#ifdef USE_PTHREADS
+  pthread_mutex_unlock(&deque->lock);
+#endif
+}
+
+static void deque_push(task_deque_t *deque, task_t *task) {
+  deque_lock(deque);
+  size_t size = deque->bottom - deque->top;
+  if (size == deque->capacity) {
+    task_t **tasks = malloc(sizeof(task_t *) * deque->capacity * 2);
+    assert(tasks);
+    for (size_t i = 0; i < size; i++) {
+      tasks[i] = deque->tasks[(deque->top + i) % deque->capacity];
+    }
+    free(deque->tasks);
+    deque->tasks = tasks;
+    deque->capacity *= 2;
+    deque->top = 0;
+    deque->bottom = size;
+  }
+  deque->tasks[deque->bottom % deque->capacity] = task;
+  deque->bottom++;
+  deque_unlock(deque);
+}
+
+/**
+ * Takes the newest task from a deque, or returns NULL if it is empty.
+ */
+static task_t *deque_pop(task_deque_t *deque) {
+  task_t *task = NULL;
+  deque_lock(deque);
+  if (deque->bottom != deque->top) {
+    deque->bottom--;
+    task = deque->tasks[deque->bottom % deque->capacity];
+  }
+  deque_unlock(deque);
+  return task;
+}
+
+/**
+ * Takes the oldest task from a deque, or returns NULL if it is empty.
+ */
+static task_t *deque_steal(task_deque_t *deque) {
+  task_t *task = NULL;
+  deque_lock(deque);
+  if (deque->bottom != deque->top) {
+    task = deque->tasks[deque->top % deque->capacity];
+    deque->top++;
+  }
+  deque_unlock(deque);
+  return task;
+}
+
+/**
+ * Gets the deque the calling thread pushes to and pops from.
+ */
+static size_t thread_pool_self(thread_pool_t *pool) {
+  return current_pool == pool ? current_deque : 0;
+}
+
+/**
+ * Queues a task whose dependencies have all finished.
+ */
+static void thread_pool_push(thread_pool_t *pool, task_t *task) {
+  deque_push(&pool->deques[thread_pool_self(pool)], task);
+  atomic_fetch_add(&pool->num_ready, 1);
+#ifdef USE_PTHREADS
+  pthread_mutex_lock(&pool->sleep_lock);
+  pthread_cond_signal(&pool->work_ready);
+  pthread_mutex_unlock(&pool->sleep_lock);
+#endif
+}
+
+/**
+ * Takes a ready task: the newest one from the thread's own deque if it has
+ * any, otherwise the oldest one from the first other deque that has any.
+ *
+ * @return the task, or NULL if no tasks are ready
+ */
+static task_t *thread_pool_take(thread_pool_t *pool, size_t self) {
+  task_t *task = deque_pop(&pool->deques[self]);
+  for (size_t i = 1; task == NULL && i < pool->num_threads; i++) {
+    task = deque_steal(&pool->deques[(self + i) % pool->num_threads]);
+  }
+  if (task != NULL) {
+    atomic_fetch_sub(&pool->num_ready, 1);
+  }
+  return task;
+}
+
+/**
+ * Runs a task, then queues the dependents it was the last dependency of.
+ */
+static void thread_pool_execute(thread_pool_t *pool, task_t *task) {
+  task->job(task->aux, task->index);
+  for (size_t i = 0; i < task->num_dependents; i++) {
+    task_t *dependent = task->dependents[i];
+    if (atomic_fetch_sub(&dependent->unmet, 1) == 1) {
+      thread_pool_push(pool, dependent);
+    }
+  }
+  // the waiting thread may free the task as soon as this is set
+  atomic_store(&task->finished, true);
+}
+
+#ifdef USE_PTHREADS
+static void *thread_pool_worker(void *arg) {
+  worker_t *worker = arg;
+  thread_pool_t *pool = worker->pool;
+  current_pool = pool;
+  current_deque = worker->index;
+  while (true) {
+    task_t *task = thread_pool_take(pool, worker->index);
+    if (task != NULL) {
+      thread_pool_execute(pool, task);
+      continue;
+    }
+    pthread_mutex_lock(&pool->sleep_lock);
+    while (!pool->stopping && atomic_load(&pool->num_ready) == 0) {
+      pthread_cond_wait(&pool->work_ready, &pool->sleep_lock);
+    }
+    bool stopping = pool->stopping;
+    pthread_mutex_unlock(&pool->sleep_lock);
+    if (stopping) {
+      break;
+    }
+  }
+  return NULL;
+}
+#endif
+
+thread_pool_t *thread_pool_init(size_t num_threads) {
+  assert(num_threads >= 1);
+  thread_pool_t *pool = malloc(sizeof(thread_pool_t));
+  assert(pool);
+#ifndef USE_PTHREADS
+  num_threads = 1;
+#endif
+  pool->num_threads = num_threads;
+  pool->deques = malloc(sizeof(task_deque_t) * num_threads);
+  assert(pool->deques);
+  for (size_t i = 0; i < num_threads; i++) {
+    deque_init(&pool->deques[i]);
+  }
+  atomic_init(&pool->num_ready, 0);
+  pool->batch = NULL;
+  pool->batch_capacity = 0;
+  atomic_init(&pool->batch_busy, false);
+#ifdef USE_PTHREADS
+  pthread_mutex_init(&pool->sleep_lock, NULL);
+  pthread_cond_init(&pool->work_ready, NULL);
+  pool->stopping = false;
+  // deque 0 is worked on by whichever thread waits for tasks
+  pool->workers = malloc(sizeof(worker_t) * num_threads);
+  assert(pool->workers);
+  for (size_t i = 1; i < num_threads; i++) {
+    worker_t *worker = &pool->workers[i];
+    worker->pool = pool;
+    worker->index = i;
+    int error =
+        pthread_create(&worker->thread, NULL, thread_pool_worker, worker);
+    assert(error == 0);
+  }
+#endif
+  return pool;
+}
+
+void thread_pool_free(thread_pool_t *pool) {
+#ifdef USE_PTHREADS
+  pthread_mutex_lock(&pool->sleep_lock);
+  pool->stopping = true;
+  pthread_cond_broadcast(&pool->work_ready);
+  pthread_mutex_unlock(&pool->sleep_lock);
+  for (size_t i = 1; i < pool->num_threads; i++) {
+    pthread_join(pool->workers[i].thread, NULL);
+  }
+  pthread_mutex_destroy(&pool->sleep_lock);
+  pthread_cond_destroy(&pool->work_ready);
+  free(pool->workers);
+#endif
+  for (size_t i = 0; i < pool->num_threads; i++) {
+    deque_free(&pool->deques[i]);
+  }
+  free(pool->deques);
+  free(pool->batch);
+  free(pool);
+}
+
+size_t thread_pool_num_threads(thread_pool_t *pool) {
+  return pool->num_threads;
+}
+
+static void task_reset(task_t *task, job_func_t job, void *aux,
+                       size_t index) {
+  task->job = job;
+  task->aux = aux;
+  task->index = index;
+  atomic_init(&task->unmet, 1);
+  task->submitted = false;
+  atomic_init(&task->finished, false);
+  task->dependents = NULL;
+  task->num_dependents = 0;
+  task->dependent_capacity = 0;
+}
+
+task_t *thread_pool_task_init(job_func_t job, void *aux, size_t index) {
+  task_t *task = malloc(sizeof(task_t));
+  assert(task);
+  task_reset(task, job, aux, index);
+  return task;
+}
+
+void thread_pool_task_depends_on(task_t *task, task_t *dependency) {
+  // a submitted dependency may already have finished and queued its
+  // dependents, so it would never release this task
+  assert(!task->submitted && !dependency->submitted);
+  if (dependency->num_dependents == dependency->dependent_capacity) {
+    dependency->dependent_capacity = dependency->dependent_capacity == 0
+                                         ? INITIAL_NUM_DEPENDENTS
+                                         : dependency->dependent_capacity * 2;
+    dependency->dependents =
+        realloc(dependency->dependents,
+                sizeof(task_t *) * dependency->dependent_capacity);
+    assert(dependency->dependents);
+  }
+  dependency->dependents[dependency->num_dependents++] = task;
+  atomic_fetch_add(&task->unmet, 1);
+}
+
+void thread_pool_submit(thread_pool_t *pool, task_t *task) {
+  assert(!task->submitted);
+  task->submitted = true;
+  if (atomic_fetch_sub(&task->unmet, 1) == 1) {
+    thread_pool_push(pool, task);
+  }
+}
+
+/**
+ * Runs other tasks until a submitted task has finished.
+ */
+static void thread_pool_wait_finished(thread_pool_t *pool, task_t *task) {
+  size_t self = thread_pool_self(pool);
+  while (!atomic_load(&task->finished)) {
+    task_t *ready = thread_pool_take(pool, self);
+    if (ready != NULL) {
+      thread_pool_execute(pool, ready);
+      continue;
+    }
+#ifdef USE_PTHREADS
+    // another thread is still running the task or one it depends on
+    sched_yield();
+#else
+    assert(!"the task depends on a task that was never submitted");
+#endif
+  }
+}
+
+void thread_pool_wait(thread_pool_t *pool, task_t *task) {
+  thread_pool_wait_finished(pool, task);
+  free(task->dependents);
+  free(task);
+}
+
+void thread_pool_run(thread_pool_t *pool, job_func_t job, void *aux,
+                     size_t num_jobs) {
+  if (num_jobs == 0) {
+    return;
+  }
+  // the scene runs a batch every tick, so its tasks reuse the pool's
+  // storage; a batch started by a job of another batch can't
+  task_t *tasks;
+  bool own_batch = atomic_exchange(&pool->batch_busy, true);
+  if (own_batch) {
+    tasks = malloc(sizeof(task_t) * num_jobs);
+    assert(tasks);
+  } else {
+    if (num_jobs > pool->batch_capacity) {
+      free(pool->batch);
+      pool->batch = malloc(sizeof(task_t) * num_jobs);
+      assert(pool->batch);
+      pool->batch_capacity = num_jobs;
+    }
+    tasks = pool->batch;
+  }
+  for (size_t i = 0; i < num_jobs; i++) {
+    task_reset(&tasks[i], job, aux, i);
+    thread_pool_submit(pool, &tasks[i]);
+  }
+  for (size_t i = 0; i < num_jobs; i++) {
+    thread_pool_wait_finished(pool, &tasks[i]);
+  }
+  if (own_batch) {
+    free(tasks);
+  } else {
+    atomic_store(&pool->batch_busy, false);
+  }
+}
+
+static void parallel_for_chunk(void *aux, size_t index) {
+  parallel_for_aux_t *range = aux;
+  size_t count = range->end - range->start;
+  size_t start = range->start + count * index / range->num_chunks;
+  size_t end = range->start + count * (index + 1) / range->num_chunks;
+  range->func(range->aux, start, end);
+}
+
+void thread_pool_parallel_for(thread_pool_t *pool, range_func_t func,
+                              void *aux, size_t start, size_t end,
+                              size_t grain) {
+  if (end <= start) {
+    return;
+  }
+  if (grain == 0) {
+    grain = 1;
+  }
+  // rounding down keeps every chunk at least `grain` long
+  size_t num_chunks = (end - start) / grain;
+  if (num_chunks == 0) {
+    num_chunks = 1;
+  }
+  size_t max_chunks = pool->num_threads * CHUNKS_PER_THREAD;
+  if (num_chunks > max_chunks) {
+    num_chunks = max_chunks;
+  }
+  if (num_chunks == 1) {
+    func(aux, start, end);
+    return;
+  }
+  parallel_for_aux_t range = {func, aux, start, end, num_chunks};
+  thread_pool_run(pool, parallel_for_chunk, &range, num_chunks);
+}
@@ -0,0 +1,212 @@
+#include "test_util.h"
+#include "thread_pool.h"
+#include <assert.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <time.h>
+
+#ifdef USE_PTHREADS
+#include <sched.h>
+#endif
+
+const size_t NUM_THREADS = 4;
+// long enough for a sleeping worker to wake up and steal a task
+const time_t STEAL_TIMEOUT_S = 5;
+
+typedef struct order {
+  atomic_size_t next;
+  size_t positions[8];
+} order_t;
+
+// records the order in which the tasks of a chain finish
+static void record_order(void *aux, size_t index) {
+  order_t *order = aux;
+  order->positions[index] = atomic_fetch_add(&order->next, 1);
+}
+
+void test_dependencies() {
+  thread_pool_t *pool = thread_pool_init(NUM_THREADS);
+  order_t order;
+  atomic_init(&order.next, 0);
+  // a diamond: 0 before 1 and 2, which are both before 3
+  task_t *tasks[4];
+  for (size_t i = 0; i < 4; i++) {
+    tasks[i] = thread_pool_task_init(record_order, &order, i);
+  }
+  thread_pool_task_depends_on(tasks[1], tasks[0]);
+  thread_pool_task_depends_on(tasks[2], tasks[0]);
+  thread_pool_task_depends_on(tasks[3], tasks[1]);
+  thread_pool_task_depends_on(tasks[3], tasks[2]);
+  // submitted in reverse, so that no task can run just by being first
+  for (size_t i = 4; i-- > 0;) {
+    thread_pool_submit(pool, tasks[i]);
+  }
+  for (size_t i = 0; i < 4; i++) {
+    thread_pool_wait(pool, tasks[i]);
+  }
+  assert(order.positions[0] == 0);
+  assert(order.positions[1] < order.positions[3]);
+  assert(order.positions[2] < order.positions[3]);
+  assert(order.positions[3] == 3);
+  thread_pool_free(pool);
+}
+
+typedef struct submitted_dependency {
+  thread_pool_t *pool;
+  task_t *dependency;
+  task_t *task;
+} submitted_dependency_t;
+
+static void do_nothing(void *aux, size_t index) {}
+
+static void depend_on_submitted(void *aux) {
+  submitted_dependency_t *tasks = aux;
+  thread_pool_task_depends_on(tasks->task, tasks->dependency);
+}
+
+void test_depends_on_submitted_task() {
+  thread_pool_t *pool = thread_pool_init(NUM_THREADS);
+  submitted_dependency_t tasks = {pool,
+                                  thread_pool_task_init(do_nothing, NULL, 0),
+                                  thread_pool_task_init(do_nothing, NULL, 1)};
+  thread_pool_submit(pool, tasks.dependency);
+  thread_pool_wait(pool, tasks.dependency);
+  tasks.dependency = thread_pool_task_init(do_nothing, NULL, 0);
+  thread_pool_submit(pool, tasks.dependency);
+  assert(test_assert_fail(depend_on_submitted, &tasks));
+  thread_pool_wait(pool, tasks.dependency);
+  thread_pool_submit(pool, tasks.task);
+  thread_pool_wait(pool, tasks.task);
+  thread_pool_free(pool);
+}
+
+typedef struct rendezvous {
+  size_t num_jobs;
+  atomic_size_t arrived;
+  atomic_bool timed_out;
+} rendezvous_t;
+
+// waits until every job of the batch has started, which only happens if the
+// other threads stole them from the submitting thread's deque
+static void meet(void *aux, size_t index) {
+  rendezvous_t *rendezvous = aux;
+  atomic_fetch_add(&rendezvous->arrived, 1);
+  time_t deadline = time(NULL) + STEAL_TIMEOUT_S;
+  while (atomic_load(&rendezvous->arrived) < rendezvous->num_jobs) {
+    if (time(NULL) > deadline) {
+      atomic_store(&rendezvous->timed_out, true);
+      return;
+    }
+#ifdef USE_PTHREADS
+    sched_yield();
+#endif
+  }
+}
+
+void test_stealing() {
+  thread_pool_t *pool = thread_pool_init(NUM_THREADS);
+  size_t num_threads = thread_pool_num_threads(pool);
+#ifdef USE_PTHREADS
+  assert(num_threads == NUM_THREADS);
+#else
+  assert(num_threads == 1);
+#endif
+  rendezvous_t rendezvous = {.num_jobs = num_threads};
+  atomic_init(&rendezvous.arrived, 0);
+  atomic_init(&rendezvous.timed_out, false);
+  thread_pool_run(pool, meet, &rendezvous, num_threads);
+  assert(!atomic_load(&rendezvous.timed_out));
+  assert(atomic_load(&rendezvous.arrived) == num_threads);
+  thread_pool_free(pool);
+}
+
+typedef struct coverage {
+  atomic_int *visits;
+  atomic_size_t num_chunks;
+  size_t grain;
+  atomic_bool short_chunk;
+} coverage_t;
+
+static void visit_range(void *aux, size_t start, size_t end) {
+  coverage_t *coverage = aux;
+  atomic_fetch_add(&coverage->num_chunks, 1);
+  if (end - start < coverage->grain) {
+    atomic_store(&coverage->short_chunk, true);
+  }
+  for (size_t i = start; i < end; i++) {
+    atomic_fetch_add(&coverage->visits[i], 1);
+  }
+}
+
+// runs a parallel for over [start, end) and checks every index was visited
+// exactly once, in chunks of at least `grain` indices
+static size_t check_parallel_for(thread_pool_t *pool, size_t start,
+                                 size_t end, size_t grain) {
+  coverage_t coverage = {.grain = grain};
+  coverage.visits = malloc(sizeof(atomic_int) * (end + 1));
+  assert(coverage.visits);
+  for (size_t i = 0; i <= end; i++) {
+    atomic_init(&coverage.visits[i], 0);
+  }
+  atomic_init(&coverage.num_chunks, 0);
+  atomic_init(&coverage.short_chunk, false);
+  thread_pool_parallel_for(pool, visit_range, &coverage, start, end, grain);
+  for (size_t i = 0; i <= end; i++) {
+    assert(atomic_load(&coverage.visits[i]) == (start <= i && i < end));
+  }
+  // a range shorter than the grain is still run, in one chunk
+  assert(!atomic_load(&coverage.short_chunk) || end - start < grain);
+  free(coverage.visits);
+  return atomic_load(&coverage.num_chunks);
+}
+
+void test_parallel_for_chunking() {
+  thread_pool_t *pool = thread_pool_init(NUM_THREADS);
+  size_t max_chunks = 4 * thread_pool_num_threads(pool);
+  assert(check_parallel_for(pool, 5, 5, 1) == 0);
+  assert(check_parallel_for(pool, 0, 3, 8) == 1);
+  assert(check_parallel_for(pool, 0, 10, 4) == 2);
+  assert(check_parallel_for(pool, 3, 19, 4) == 4);
+  size_t num_chunks = check_parallel_for(pool, 0, 10000, 1);
+  assert(num_chunks == max_chunks);
+  thread_pool_free(pool);
+}
+
+// batches of growing size, like the scene's ticks as bodies are added
+void test_repeated_batches() {
+  thread_pool_t *pool = thread_pool_init(NUM_THREADS);
+  for (size_t batch = 1; batch <= 100; batch++) {
+    assert(check_parallel_for(pool, 0, batch * 7, 1) >= 1);
+  }
+  thread_pool_free(pool);
+}
+
+static void run_inner_batch(void *aux, size_t index) {
+  assert(check_parallel_for(aux, 0, 100, 1) >= 1);
+}
+
+// a job that runs a batch of its own while the outer batch is running
+void test_nested_batches() {
+  thread_pool_t *pool = thread_pool_init(NUM_THREADS);
+  thread_pool_run(pool, run_inner_batch, pool, 8);
+  thread_pool_free(pool);
+}
+
+int main(int argc, char *argv[]) {
+  // Run all tests if there are no command-line arguments
+  bool all_tests = argc == 1;
+  // Read test name from file
+  char testname[100];
+  if (!all_tests) {
+    read_testname(argv[1], testname, sizeof(testname));
+  }
+
+  DO_TEST(test_dependencies)
+  DO_TEST(test_depends_on_submitted_task)
+  DO_TEST(test_stealing)
+  DO_TEST(test_parallel_for_chunking)
+  DO_TEST(test_repeated_batches)
+  DO_TEST(test_nested_batches)
+
+  puts("thread_pool_test PASS");
+}